@@ -0,0 +1,63 @@
+# cmake -DLAB=<lab problems> -DBIN=<where the programs are> -P pgo_train.cmake
+#
+# Every solver on every input of its corpus (the input on stdin), then every
+# multitext driver over its whole corpus (how many inputs on stdin), from the
+# problem's directory like the drivers expect, then bench once over every
+# engine (the engines compiled into it need their own profile). Relay stops at input 16: the
+# quadratic DAG of the bigger ones needs more memory than a small machine has.
+
+# solver dir corpus first last
+function(train_solver program dir corpus first last)
+    foreach(i RANGE ${first} ${last})
+        execute_process(COMMAND "${BIN}/${program}"
+                        INPUT_FILE "${LAB}/${dir}/${corpus}/input${i}.txt"
+                        OUTPUT_QUIET TIMEOUT 600 RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(WARNING "${program} on ${corpus}/input${i}.txt: ${result}")
+        endif()
+    endforeach()
+endfunction()
+
+# driver dir inputs
+function(train_driver program dir inputs)
+    file(WRITE "${BIN}/pgo-${program}.count" "${inputs}\n")
+    execute_process(COMMAND "${BIN}/${program}"
+                    INPUT_FILE "${BIN}/pgo-${program}.count"
+                    WORKING_DIRECTORY "${LAB}/${dir}"
+                    OUTPUT_VARIABLE output TIMEOUT 1800 RESULT_VARIABLE result)
+    string(REGEX MATCHALL "[Ww]rong" wrong "${output}")
+    list(LENGTH wrong wrong)
+    message(STATUS "${program}: ${inputs} inputs, ${wrong} wrong")
+    if(NOT result EQUAL 0 OR wrong GREATER 0)
+        message(WARNING "${program} exited with ${result}, ${wrong} wrong")
+    endif()
+endfunction()
+
+# bench arguments...
+function(train_bench)
+    execute_process(COMMAND "${BIN}/bench" --warmup 0 --reps 1 ${ARGN}
+                    OUTPUT_VARIABLE output TIMEOUT 1800 RESULT_VARIABLE result)
+    string(REGEX MATCH "[0-9]+ cases, [0-9]+ not right" summary "${output}")
+    string(REPLACE ";" " " arguments "${ARGN}")
+    message(STATUS "bench ${arguments}: ${summary}")
+    if(NOT result EQUAL 0)
+        message(WARNING "bench ${arguments} exited with ${result}")
+    endif()
+endfunction()
+
+train_solver(cereal 1/problem1 cereal 1 20)
+train_solver(shops2 1/problem2 shops2 1 25)
+train_solver(salaries 2/salaries salaries 1 25)
+train_solver(relay 2/relay relay 1 16)
+train_solver(contagion 3/contagion contagion 1 20)
+train_solver(shortcuts 3/shortcuts shortcuts 0 20)
+
+train_driver(cereal_test 1/problem1 20)
+train_driver(shops2_v2 1/problem2 25)
+train_driver(salaries_multitext 2/salaries 25)
+train_driver(relay_multitext 2/relay 16)
+train_driver(contagion-multitext 3/contagion 20)
+train_driver(shortcuts-multitext 3/shortcuts 20)
+
+train_bench(cereal shops2 salaries contagion shortcuts)
+train_bench(--cases 0-16 relay)
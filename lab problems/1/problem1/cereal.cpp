@@ -1,129 +1,73 @@
-#include <algorithm>
-#include <iostream>
-#include <vector>
-#include <fstream>
-#include <utility>
+#include "cereal.hpp"
 
 using namespace std;
-/*
- * Let's consider the sequence a1, a2, ..., aK of positive integers
- * and let's call median it's median (number that would be at position
- * floor((K+1)/2) in the sorted list).
- * 
- * Let's consider a number M and the sequence b1, b2, ..., bK
- * where bj = (aj >= M)?(1):(-1) and S = b1 + b2 + ... + bK
- * if (S > 0) then 
- *  	M <= median (search in bigger numbers)
- * 		else M > median (search in smaller numbers)
- * This is gonna help us implement a binary search for the maximum median
- * since we know the range in which it belongs before hand
- * 
- * let's say we create array prefix where prefix[i] = b1 + ... + bi
- * If we want to calculate the sum S for a sequence of length L which
- * has bj as it's last element then we simply do S = prefix[j] - prefix[j - L + 1]
- * 
- * Suppose that we are trying to see if any of the subsequences ending in the element
- * with index j with length at least K is responsible for a positive value of S.
- * Then we need to check for S = prefix[j] - subtrahend,
- * where subtrahend = 0, prefix[1], ..., prefix[j - K + 1].
- * Note that we only care if S happens to be positive in just one of these. If we keep
- * only the minimum value of the subtrahends then we remove from prefix[j] as little
- * an amount as possible thus keeping in as large as possible thus we only need to
- * check if prefix[j] - min{0,prefix[1],...,prefix[j - K + 1]} is positive...
- */
+using namespace cereal;
 
-
-/*
- * this function returns a vector with the input array
- * and a vector with all the different possible values
- * sorted in O(N) time and space
- */
-pair <vector<int>,vector<int>> \
-read_input(istream& in, int& N, int& K)
+int main(int argc, char* argv[])
 {
-	in >> N >> K;
-	vector<int> c(N);
-	vector<bool> exists(N + 1,false);
-
-	for (int i = 0; i < c.size(); ++i)
-	{
-		in >> c[i];//0 < c[i] <= N
-		exists[c[i]] = true;
+	IntReader in; // standard input
+	if (argc > 1 && string(argv[1]) == "--stream")
+	{ // the input is K and then batches: B followed by B values, until the end.
+	  // After every batch we print the answer so far ("none" before K values).
+		int K, B;
+		in >> K;
+		StreamingCereal stream(K);
+		while (in >> B)
+		{
+			vector<long long> batch(B);
+			for (long long& value : batch)
+				in >> value;
+			stream.append(batch);
+			if (stream.ready())
+				cout << stream.answer() << "\n";
+			else
+				cout << "none\n";
+		}
+		return 0;
 	}
-	vector<int> num_appear;
-	for (int i = 1; i <= c.size(); ++i)
-	{
-		if(exists[i])
-			num_appear.push_back(i);
-	}
-	num_appear.shrink_to_fit();
-
-	return make_pair(c,num_appear);
-}
 
-
-/*
- * just create the prefix sum array...
- */
-vector<int> prefixer(vector<int>& c, int M)
-{
-	int N = c.size();
-	vector<int> prefix(N);
-	for(int i = 0; i < N; ++i)
-	{
-		if (c[i] >= M)
-			prefix[i] = 1;
-		else
-			prefix[i] = -1;
-		if (i != 0)
-			prefix[i] += prefix[i - 1];
-	}
-	return prefix;
-}
-
-/*
- * this function checks for the existence of at least one
- * positive S as described above...
- */
-
-bool posS(vector<int>& prefix, int K, int M)
-{
-	int minuend = prefix[K - 1]; // sum of first K elements
-	int subtrahend = 0; // there initially exist no elements before
-						// those included in the minuend
-	for(int i = K; i < prefix.size() && minuend <= 0; ++i)
+	int N, K;
+	pair <vector<int>,vector<long long>> input;
+	if (argc > 2 && string(argv[1]) == "--bin") // an inputN.bin of corpus_convert instead of stdin
 	{
-		subtrahend = min(subtrahend,prefix[i - K]);
-		minuend = prefix[i] - subtrahend;
+		CorpusFile file(argv[2], CORPUS_CEREAL);
+		if (!file)
+		{
+			cerr << argv[2] << ": " << file.what() << endl;
+			return 1;
+		}
+		input = load_input(file,N,K);
 	}
-	return minuend > 0;
-}
-
-int main()
-{
-	int N, K;
-	pair <vector<int>,vector<int>> input = read_input(cin,N,K);
+	else
+		input = read_input(in,N,K);
 	vector<int> c = input.first;
-	vector<int> appearances = input.second;
-
-	int first = 1, last = appearances.size();
+	vector<long long> appearances = input.second;
 
-	while(first != last)
+	if (argc > 1 && string(argv[1]) == "--kary") // same answer, fewer passes over c
 	{
-		int mid = (first + last + 1)/2; // get the ceiling to avoid
-										// infinite loops
-		int M = appearances[mid - 1];
-		vector<int> prefix = prefixer(c,M);
-		if(posS(prefix,K,M))
-			first = mid; // median >= M so we check the biger numbers
-						 // including the position of M, since it still
-						 // is a candidate
+		cout << maxMedianKary(c,K,appearances) << endl;
+		return 0;
+	}
+	if (argc > 1 && (string(argv[1]) == "--all-k" || string(argv[1]) == "--queries"))
+	{ // --all-k: the answer for K = 1, ..., N, --queries: after the input
+	  // comes Q and then Q values of K. One answer per line, in that order.
+		vector<int> Ks;
+		if (string(argv[1]) == "--all-k")
+			for (int k = 1; k <= N; ++k)
+				Ks.push_back(k);
 		else
-			last = mid - 1; // median < M, so we check numbers that are
-			                // strictly smaller than M...
- 	}
-	cout << appearances[first - 1] << endl;// first = last, this is the only acceptable
-										   // value left and first is always a legal value
-										   // for median so it is the maximum possible value
+		{
+			int Q;
+			in >> Q;
+			Ks.resize(Q);
+			for (int& k : Ks)
+				in >> k; // 1 <= k <= N
+		}
+		for (long long answer : maxMedians(c,Ks,appearances))
+			cout << answer << "\n";
+		return 0;
+	}
+
+	cout << maxMedian(c,K,appearances,max(1u, thread::hardware_concurrency())) << endl;
 	return 0;
 }
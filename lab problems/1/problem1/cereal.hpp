@@ -0,0 +1,601 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <climits>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <set>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#include "../../common/int_reader.hpp"
+#include "../../common/corpus.hpp"
+#include "../../common/radix_sort.hpp"
+
+namespace cereal
+{
+using namespace std;
+
+/*
+ * Let's consider the sequence a1, a2, ..., aK of positive integers
+ * and let's call median it's median (number that would be at position
+ * floor((K+1)/2) in the sorted list).
+ * 
+ * Let's consider a number M and the sequence b1, b2, ..., bK
+ * where bj = (aj >= M)?(1):(-1) and S = b1 + b2 + ... + bK
+ * if (S > 0) then 
+ *  	M <= median (search in bigger numbers)
+ * 		else M > median (search in smaller numbers)
+ * This is gonna help us implement a binary search for the maximum median
+ * since we know the range in which it belongs before hand
+ * 
+ * let's say we create array prefix where prefix[i] = b1 + ... + bi
+ * If we want to calculate the sum S for a sequence of length L which
+ * has bj as it's last element then we simply do S = prefix[j] - prefix[j - L + 1]
+ * 
+ * Suppose that we are trying to see if any of the subsequences ending in the element
+ * with index j with length at least K is responsible for a positive value of S.
+ * Then we need to check for S = prefix[j] - subtrahend,
+ * where subtrahend = 0, prefix[1], ..., prefix[j - K + 1].
+ * Note that we only care if S happens to be positive in just one of these. If we keep
+ * only the minimum value of the subtrahends then we remove from prefix[j] as little
+ * an amount as possible thus keeping in as large as possible thus we only need to
+ * check if prefix[j] - min{0,prefix[1],...,prefix[j - K + 1]} is positive...
+ */
+
+
+/*
+ * this function returns the N values next_value() gives, with every value
+ * replaced by its rank among the different values (0 for the smallest one),
+ * and a vector with all the different values sorted. The values can
+ * be any 64-bit integers: radix_sort (common/radix_sort.hpp) puts the
+ * indices in sorted order (values up to N take 3 passes) and we hand out the
+ * ranks while walking that order. O(N) time and space, and what we keep
+ * is one int per element. Ranks keep the order of the values, so
+ * c[i] >= M is the same as value >= appearances[M] and everything
+ * below works on ranks.
+ */
+template <typename Values>
+pair <vector<int>,vector<long long>> \
+rank_values(int N, Values next_value)
+{
+	vector<unsigned long long> key(N);
+	vector<int> index(N);
+	for (int i = 0; i < N; ++i)
+	{
+		key[i] = radix_key((long long) next_value());
+		index[i] = i;
+	}
+	radix_sort(key, index);
+
+	vector<int> c(N);
+	vector<long long> num_appear;
+	for (int i = 0; i < N; ++i)
+	{
+		if (i == 0 || key[i] != key[i - 1])
+			num_appear.push_back(radix_value<long long>(key[i]));
+		c[index[i]] = num_appear.size() - 1;
+	}
+	num_appear.shrink_to_fit();
+
+	return make_pair(c,num_appear);
+}
+
+/* reads N, K and the N values, O(N) */
+inline pair <vector<int>,vector<long long>> \
+read_input(IntReader& in, int& N, int& K)
+{
+	in >> N >> K;
+	return rank_values(N, [&]{ return in.next<long long>(); });
+}
+
+/* the same from an inputN.bin of corpus_convert, file has to be an open
+ * CORPUS_CEREAL case (see common/corpus.hpp) */
+inline pair <vector<int>,vector<long long>> \
+load_input(const CorpusFile& file, int& N, int& K)
+{
+	CorpusArray<int64_t> values = file.section<int64_t>(0);
+	const int64_t* next = values.begin();
+	N = values.size();
+	K = file.size(1);
+	return rank_values(N, [&]{ return (long long) *next++; });
+}
+
+
+/*
+ * this function checks for the existence of at least one
+ * positive S as described above, in a single pass over c.
+ * We never build the prefix array: prefix is prefix[i] and lagging
+ * is prefix[i - K + 1], which is the newest subtrahend the next i is
+ * allowed to use, so two running sums and a running minimum are
+ * enough. We stop at the first positive S we find.
+ */
+inline bool hasMedianAtLeast(const vector<int>& c, int K, int M)
+{
+	int N = c.size();
+	int prefix = 0; // prefix[i]
+	int lagging = 0; // prefix[i - K + 1]
+	int subtrahend = 0; // min{0,prefix[0],...,prefix[i - K]}
+	for (int i = 0; i < K - 1; ++i)
+		prefix += (c[i] >= M) ? 1 : -1;
+	for (int i = K - 1; i < N; ++i)
+	{
+		prefix += (c[i] >= M) ? 1 : -1;
+		if (prefix - subtrahend > 0)
+			return true;
+		lagging += (c[i - K + 1] >= M) ? 1 : -1;
+		subtrahend = min(subtrahend, lagging);
+	}
+	return false;
+}
+
+/*
+ * Multi-threaded version of hasMedianAtLeast. c is split into one chunk
+ * [lo[t], lo[t + 1]) per thread and we go over it in two rounds:
+ * 1. every thread sums the +1/-1's of its chunk and finds the smallest
+ *    prefix inside it (counted from the start of the chunk). Combining
+ *    these left to right gives prefix[lo[t] - 1] (offset[t]) and
+ *    min{0,prefix[0],...,prefix[lo[t] - 1]} (low[t]) for every chunk.
+ * 2. every thread runs the loop of hasMedianAtLeast over its own chunk.
+ *    It starts from offset[t] and needs the lagging prefix and the
+ *    subtrahend at lo[t] - K, which it gets from the summaries of the
+ *    chunk that position falls in plus a scan of part of that chunk.
+ * Everybody stops as soon as one of them finds a positive S.
+ * Small inputs are not worth the threads, they go to hasMedianAtLeast.
+ */
+#ifndef MIN_CHUNK
+#define MIN_CHUNK (1 << 16) // smallest chunk we give to a thread
+#endif
+
+/* run work(0), ..., work(threads - 1) on that many threads and wait for them */
+template <typename Work>
+void runThreads(int threads, Work work)
+{
+	vector<thread> pool;
+	for (int t = 1; t < threads; ++t)
+		pool.emplace_back(work, t);
+	work(0);
+	for (thread& worker : pool)
+		worker.join();
+}
+
+inline bool hasMedianAtLeastParallel(const vector<int>& c, int K, int M, int threads)
+{
+	int N = c.size();
+	if (threads <= 1 || N / threads < MIN_CHUNK)
+		return hasMedianAtLeast(c, K, M);
+
+	vector<int> lo(threads + 1);
+	for (int t = 0; t <= threads; ++t)
+		lo[t] = (long long) N * t / threads;
+
+	vector<int> sum(threads), min_prefix(threads);
+	runThreads(threads, [&](int t) { // round 1
+		int running = 0, smallest = 0;
+		for (int i = lo[t]; i < lo[t + 1]; ++i)
+		{
+			running += (c[i] >= M) ? 1 : -1;
+			smallest = min(smallest, running);
+		}
+		sum[t] = running;
+		min_prefix[t] = smallest;
+	});
+
+	vector<int> offset(threads + 1, 0), low(threads + 1, 0);
+	for (int t = 0; t < threads; ++t)
+	{
+		offset[t + 1] = offset[t] + sum[t];
+		low[t + 1] = min(low[t], offset[t] + min_prefix[t]);
+	}
+
+	atomic<bool> found(false);
+	runThreads(threads, [&](int t) { // round 2
+		int i = max(lo[t], K - 1), end = lo[t + 1];
+		if (i >= end)
+			return;
+		int prefix = offset[t]; // prefix[i - 1]
+		for (int j = lo[t]; j < i; ++j)
+			prefix += (c[j] >= M) ? 1 : -1;
+
+		int lagging = 0, subtrahend = 0; // prefix[i - K] and min{0,...,prefix[i - K]}
+		if (i - K >= 0)
+		{
+			int u = upper_bound(lo.begin(), lo.end(), i - K) - lo.begin() - 1; // its chunk
+			lagging = offset[u];
+			subtrahend = low[u];
+			for (int j = lo[u]; j <= i - K; ++j)
+			{
+				lagging += (c[j] >= M) ? 1 : -1;
+				subtrahend = min(subtrahend, lagging);
+			}
+		}
+
+		for (; i < end; ++i)
+		{
+			prefix += (c[i] >= M) ? 1 : -1;
+			if (prefix - subtrahend > 0)
+			{
+				found = true;
+				return;
+			}
+			lagging += (c[i - K + 1] >= M) ? 1 : -1;
+			subtrahend = min(subtrahend, lagging);
+			if ((i & 4095) == 0 && found.load(memory_order_relaxed))
+				return; // somebody else already found one
+		}
+	});
+	return found;
+}
+
+/*
+ * The same check for many thresholds in one pass over c, this is what
+ * the k-ary search below is built on. Every threshold gets its own lane
+ * with its own prefix, lagging and subtrahend, and each c[i] is compared
+ * against all of them at once (16 lanes with AVX-512, 8 with AVX2, and
+ * a plain loop over 8 lanes otherwise).
+ * M[0] < M[1] < ... < M[count - 1], count <= LANES. If M[j] is feasible
+ * then so is every smaller threshold, so we return how many of them are
+ * feasible and those are always the first ones. We stop as soon as all
+ * of them are known to be feasible.
+ */
+#if defined(__AVX512F__)
+#define LANES 16
+#else
+#define LANES 8
+#endif
+
+inline int countMediansAtLeast(const vector<int>& c, int K, const int* M, int count)
+{
+	int N = c.size();
+	int thresholds[LANES];
+	for (int j = 0; j < LANES; ++j) // lanes we don't need can never be feasible
+		thresholds[j] = (j < count) ? M[j] : INT_MAX;
+	const int CHECK_EVERY = 256; // how often we look for an early exit
+	unsigned wanted = (1u << count) - 1, found = 0;
+
+#if defined(__AVX512F__)
+	__m512i threshold = _mm512_loadu_si512(thresholds);
+	__m512i one = _mm512_set1_epi32(1);
+	__m512i prefix = _mm512_setzero_si512(), lagging = prefix, subtrahend = prefix;
+	auto step = [&](int value) { // the +1/-1 of value in every lane
+		__mmask16 smaller = _mm512_cmplt_epi32_mask(_mm512_set1_epi32(value), threshold);
+		return _mm512_mask_blend_epi32(smaller, one, _mm512_set1_epi32(-1));
+	};
+	for (int i = 0; i < K - 1; ++i)
+		prefix = _mm512_add_epi32(prefix, step(c[i]));
+	for (int i = K - 1; i < N; ++i)
+	{
+		prefix = _mm512_add_epi32(prefix, step(c[i]));
+		found |= _mm512_cmpgt_epi32_mask(prefix, subtrahend);
+		lagging = _mm512_add_epi32(lagging, step(c[i - K + 1]));
+		subtrahend = _mm512_min_epi32(subtrahend, lagging);
+		if ((i & (CHECK_EVERY - 1)) == 0 && (found & wanted) == wanted)
+			break;
+	}
+#elif defined(__AVX2__)
+	__m256i threshold = _mm256_loadu_si256((const __m256i*) thresholds);
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i prefix = _mm256_setzero_si256(), lagging = prefix, subtrahend = prefix;
+	__m256i positive = prefix;
+	auto step = [&](int value) { // -1 where value < threshold, 1 elsewhere
+		return _mm256_or_si256(_mm256_cmpgt_epi32(threshold, _mm256_set1_epi32(value)), one);
+	};
+	for (int i = 0; i < K - 1; ++i)
+		prefix = _mm256_add_epi32(prefix, step(c[i]));
+	for (int i = K - 1; i < N; ++i)
+	{
+		prefix = _mm256_add_epi32(prefix, step(c[i]));
+		positive = _mm256_or_si256(positive, _mm256_cmpgt_epi32(prefix, subtrahend));
+		lagging = _mm256_add_epi32(lagging, step(c[i - K + 1]));
+		subtrahend = _mm256_min_epi32(subtrahend, lagging);
+		if ((i & (CHECK_EVERY - 1)) == 0)
+		{
+			found = _mm256_movemask_ps(_mm256_castsi256_ps(positive));
+			if ((found & wanted) == wanted)
+				break;
+		}
+	}
+	found = _mm256_movemask_ps(_mm256_castsi256_ps(positive));
+#else
+	int prefix[LANES] = {}, lagging[LANES] = {}, subtrahend[LANES] = {}, positive[LANES] = {};
+	for (int i = 0; i < K - 1; ++i)
+		for (int j = 0; j < LANES; ++j)
+			prefix[j] += 2 * (c[i] >= thresholds[j]) - 1;
+	for (int i = K - 1; i < N; ++i)
+	{
+		for (int j = 0; j < LANES; ++j) // no branches, so that the compiler can vectorize it
+		{
+			prefix[j] += 2 * (c[i] >= thresholds[j]) - 1;
+			positive[j] |= prefix[j] > subtrahend[j];
+			lagging[j] += 2 * (c[i - K + 1] >= thresholds[j]) - 1;
+			subtrahend[j] = min(subtrahend[j], lagging[j]);
+		}
+		if ((i & (CHECK_EVERY - 1)) == 0)
+		{
+			for (int j = 0; j < LANES; ++j)
+				found |= (unsigned) positive[j] << j;
+			if ((found & wanted) == wanted)
+				break;
+		}
+	}
+	for (int j = 0; j < LANES; ++j)
+		found |= (unsigned) positive[j] << j;
+#endif
+	found &= wanted;
+	int feasible = 0;
+	while (feasible < count && (found >> feasible & 1))
+		++feasible;
+	return feasible;
+}
+
+/*
+ * k-ary version of the binary search in main. Instead of the middle of
+ * [first, last] we test LANES positions spread evenly over (first, last]
+ * in one pass, so the range shrinks about LANES + 1 times per pass
+ * instead of 2 and we go over c about log_(LANES+1)(N) times instead
+ * of log_2(N). It returns the same value as the binary search.
+ * Without AVX2 the lanes are a plain loop and the binary search is about
+ * as fast, that is why main only uses this with --kary.
+ */
+inline long long maxMedianKary(const vector<int>& c, int K, const vector<long long>& appearances)
+{
+	int first = 1, last = appearances.size();
+	int M[LANES], position[LANES];
+	while(first != last)
+	{
+		int count = min(LANES, last - first);
+		for (int j = 0; j < count; ++j)
+		{
+			position[j] = first + (long long) (j + 1) * (last - first) / count;
+			M[j] = position[j] - 1; // its rank
+		}
+		int feasible = countMediansAtLeast(c, K, M, count);
+		if (feasible == 0)
+			last = position[0] - 1; // first is still the only legal value we know of
+		else
+		{
+			if (feasible < count)
+				last = position[feasible] - 1; // this one and everything above it failed
+			first = position[feasible - 1];
+		}
+	}
+	return appearances[first - 1];
+}
+
+/*
+ * The length of the longest window with a positive S for threshold M
+ * (0 if there is none), so M is a legal median for every K up to it.
+ * prefix moves by +1/-1 and starts from 0, so for the window ending at j
+ * the best start is right after the earliest i with prefix[i] < prefix[j]:
+ * the very beginning if prefix[j] > 0, otherwise the first time prefix
+ * went down to prefix[j] - 1. first_at[d] is the first index where
+ * prefix = -d (-1 for d = 0, before anything), filled in as prefix
+ * reaches new minimums. One pass, and first_at is given to us so that
+ * many calls can share it.
+ */
+inline int longestPositive(const vector<int>& c, int M, vector<int>& first_at)
+{
+	int N = c.size();
+	first_at.resize(N + 2);
+	first_at[0] = -1;
+	int prefix = 0, deepest = 0, longest = 0;
+	for (int j = 0; j < N; ++j)
+	{
+		prefix += (c[j] >= M) ? 1 : -1;
+		if (prefix < -deepest)
+			first_at[deepest = -prefix] = j;
+		if (prefix > 0)
+			longest = j + 1;
+		else if (1 - prefix <= deepest)
+			longest = max(longest, j - first_at[1 - prefix]);
+	}
+	return longest;
+}
+
+/*
+ * The maximum median for every K in Ks, with one call of longestPositive
+ * answering a whole group of K's at a time. The answer can only go down as
+ * K grows, so with the queries sorted by K we divide and conquer on both:
+ * queries[qlo, qhi) have their answers (as positions in appearances) in
+ * [alo, ahi]. For mid in the middle of that range the queries with
+ * K <= longestPositive(mid) get an answer >= mid and the rest < mid.
+ * Every level of the recursion goes over c once per group that is still
+ * open, so this is far less than one binary search per K.
+ */
+inline void maxMediansRange(const vector<int>& c, const vector<long long>& appearances,
+                     const vector<pair<int,int>>& queries, int qlo, int qhi,
+                     int alo, int ahi, vector<long long>& answers, vector<int>& first_at)
+{
+	if (qlo == qhi)
+		return;
+	if (alo == ahi)
+	{
+		for (int q = qlo; q < qhi; ++q)
+			answers[queries[q].second] = appearances[alo - 1];
+		return;
+	}
+	int mid = (alo + ahi + 1)/2; // ceiling, as in main
+	int longest = longestPositive(c, mid - 1, first_at); // mid - 1 is the rank
+	int split = upper_bound(queries.begin() + qlo, queries.begin() + qhi,
+	                        make_pair(longest, INT_MAX)) - queries.begin();
+	maxMediansRange(c, appearances, queries, qlo, split, mid, ahi, answers, first_at);
+	maxMediansRange(c, appearances, queries, split, qhi, alo, mid - 1, answers, first_at);
+}
+
+inline vector<long long> maxMedians(const vector<int>& c, const vector<int>& Ks, const vector<long long>& appearances)
+{
+	vector<pair<int,int>> queries; // (K, where its answer goes)
+	for (int q = 0; q < Ks.size(); ++q)
+		queries.push_back(make_pair(Ks[q], q));
+	sort(queries.begin(), queries.end());
+
+	vector<long long> answers(Ks.size());
+	vector<int> first_at;
+	maxMediansRange(c, appearances, queries, 0, queries.size(), 1, appearances.size(), answers, first_at);
+	return answers;
+}
+
+/*
+ * Streaming version: values keep being appended, K stays the same and
+ * after every batch we want the maximum median of the windows of length
+ * at least K seen so far. Appending only adds windows, so the answer
+ * never goes down and all we have to find out is whether it went up.
+ *
+ * A rung is the state of hasMedianAtLeast for the threshold "> above"
+ * (prefix, lagging, subtrahend and whether it has seen a positive S
+ * yet), kept up to date one value at a time. It is feasible exactly when
+ * the answer is bigger than above. We keep a ladder of at most LADDER
+ * rungs: one for the current answer and some for values above it, so a
+ * batch costs its length times the number of rungs. After it:
+ * - no rung is feasible: the answer stays the same.
+ * - rung j is the highest feasible one: the answer is one of the values
+ *   in (above_j, above_j+1] (or above above_j if j is the top). Usually
+ *   that is just above_j+1, otherwise we binary search those values
+ *   with passes over the history. The rungs below the new answer go
+ *   away, and once half the ladder is gone we add new rungs on top,
+ *   all of them caught up over the history in a single pass.
+ */
+#define LADDER 16
+
+class StreamingCereal
+{
+public:
+	StreamingCereal(int K) : K(K), found(false) {}
+
+	void append(const vector<long long>& batch)
+	{
+		for (long long value : batch)
+		{
+			history.push_back(value);
+			values.insert(value);
+			for (Rung& rung : rungs)
+				step(rung, history.size() - 1);
+		}
+		if (history.size() < K)
+			return; // no windows yet
+
+		set<long long>::iterator from = values.begin(), to = values.end();
+		if (found)
+		{
+			int j = rungs.size() - 1;
+			while (j >= 0 && !rungs[j].feasible)
+				--j;
+			if (j < 0)
+				return; // the answer is the same
+			from = values.upper_bound(rungs[j].above);
+			if (j + 1 < rungs.size())
+				to = next(values.find(rungs[j + 1].above));
+		}
+		best = search(from, to);
+		found = true;
+		climb();
+	}
+
+	bool ready() const { return found; } // false until K values have come
+
+	long long answer() const { return best; }
+
+private:
+	struct Rung
+	{
+		long long above;
+		int prefix, lagging, subtrahend;
+		bool feasible;
+	};
+
+	int K;
+	vector<long long> history;
+	set<long long> values; // the different values seen so far
+	vector<Rung> rungs; // sorted by above, rungs[0].above is the answer
+	long long best;
+	bool found;
+
+	/* the loop body of hasMedianAtLeast for history[i] */
+	void step(Rung& rung, int i)
+	{
+		rung.prefix += (history[i] > rung.above) ? 1 : -1;
+		if (i < K - 1)
+			return;
+		if (rung.prefix - rung.subtrahend > 0)
+			rung.feasible = true;
+		rung.lagging += (history[i - K + 1] > rung.above) ? 1 : -1;
+		rung.subtrahend = min(rung.subtrahend, rung.lagging);
+	}
+
+	/* the answer is the biggest legal value in [from, to) and *from is
+	 * known to be legal: binary search, each step a pass over the history */
+	long long search(set<long long>::iterator from, set<long long>::iterator to)
+	{
+		vector<long long> candidates(from, to);
+		int first = 1, last = candidates.size();
+		while(first != last)
+		{
+			int mid = (first + last + 1)/2;
+			Rung rung{candidates[mid - 2], 0, 0, 0, false}; // "> previous" is ">= candidates[mid - 1]"
+			for (int i = 0; i < history.size() && !rung.feasible; ++i)
+				step(rung, i);
+			if (rung.feasible)
+				first = mid;
+			else
+				last = mid - 1;
+		}
+		return candidates[first - 1];
+	}
+
+	/* move the ladder up to the new answer */
+	void climb()
+	{
+		vector<Rung> kept, fresh;
+		for (const Rung& rung : rungs)
+			if (rung.above >= best)
+				kept.push_back(rung);
+		if (kept.empty() || kept[0].above != best)
+			fresh.push_back(Rung{best, 0, 0, 0, false});
+		if (kept.size() + fresh.size() <= LADDER / 2) // time to add some on top
+		{
+			auto next = values.upper_bound(kept.empty() ? best : kept.back().above);
+			for (; kept.size() + fresh.size() < LADDER && next != values.end(); ++next)
+				fresh.push_back(Rung{*next, 0, 0, 0, false});
+		}
+		for (int i = 0; i < history.size() && !fresh.empty(); ++i)
+			for (Rung& rung : fresh)
+				step(rung, i);
+
+		rungs = kept;
+		rungs.insert(rungs.end(), fresh.begin(), fresh.end());
+		sort(rungs.begin(), rungs.end(), [](const Rung& x, const Rung& y) { return x.above < y.above; });
+	}
+};
+
+/*
+ * the maximum median: a binary search over the ranks, each step
+ * checked with hasMedianAtLeastParallel on threads threads
+ */
+inline long long maxMedian(const vector<int>& c, int K, const vector<long long>& appearances, int threads)
+{
+	int first = 1, last = appearances.size();
+
+	while(first != last)
+	{
+		int mid = (first + last + 1)/2; // get the ceiling to avoid
+										// infinite loops
+		int M = mid - 1; // the rank of appearances[mid - 1]
+		if(hasMedianAtLeastParallel(c,K,M,threads))
+			first = mid; // median >= M so we check the biger numbers
+						 // including the position of M, since it still
+						 // is a candidate
+		else
+			last = mid - 1; // median < M, so we check numbers that are
+			                // strictly smaller than M...
+ 	}
+	return appearances[first - 1]; // first = last, this is the only acceptable
+								   // value left and first is always a legal value
+								   // for median so it is the maximum possible value
+}
+
+} // namespace cereal
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <span>
+#include <thread>
+#include <string>
+#include "../../common/int_reader.hpp"
+#include "../../common/corpus.hpp"
+
+namespace shops2
+{
+using namespace std;
+
+/*
+ * Sparse replacement for lls when K is huge: an open-addressing table
+ * from sums (int64) to lengths (int32) that only holds sums we actually
+ * reached. Empty slots have key -1 (sums are never negative), slots are
+ * picked with a Fibonacci hash and probed linearly, and the table doubles
+ * once it's half full. reset() keeps the memory of the previous instance.
+ */
+struct sparse_lengths
+{
+    vector<long long> keys;
+    vector<int> lengths;
+    int shift, used;
+    int missing; // what a sum we never saw maps to, like N + 1 in lls
+
+    void reset(long long expected, int missing_length)
+    {
+        int bits = 4;
+        while ((1LL << bits) < 2 * expected) ++bits;
+        shift = 64 - bits;
+        used = 0;
+        missing = missing_length;
+        keys.assign(1LL << bits, -1);
+        lengths.resize(1LL << bits);
+    }
+
+    size_t slot(long long sum) const
+    {
+        return (unsigned long long)sum * 0x9E3779B97F4A7C15ULL >> shift;
+    }
+
+    int at(long long sum) const
+    {
+        size_t mask = keys.size() - 1;
+        for (size_t i = slot(sum); ; i = (i + 1) & mask)
+        {
+            if (keys[i] == sum) return lengths[i];
+            if (keys[i] == -1) return missing;
+        }
+    }
+
+    void keep_min(long long sum, int length)
+    {
+        size_t mask = keys.size() - 1, i = slot(sum);
+        for (; keys[i] != -1; i = (i + 1) & mask)
+            if (keys[i] == sum)
+            {
+                lengths[i] = min(lengths[i], length);
+                return;
+            }
+        keys[i] = sum;
+        lengths[i] = length;
+        if (2 * ++used > (int)keys.size()) grow();
+    }
+
+    void grow()
+    {
+        vector<long long> old_keys(keys.size() * 2, -1);
+        vector<int> old_lengths(lengths.size() * 2);
+        old_keys.swap(keys);
+        old_lengths.swap(lengths);
+        --shift;
+        size_t mask = keys.size() - 1;
+        for (size_t j = 0; j < old_keys.size(); ++j)
+            if (old_keys[j] != -1)
+            {
+                size_t i = slot(old_keys[j]);
+                while (keys[i] != -1) i = (i + 1) & mask;
+                keys[i] = old_keys[j];
+                lengths[i] = old_lengths[j];
+            }
+    }
+};
+
+// the dense lls with the same interface, so the sweep can take either
+struct dense_lengths
+{
+    vector<int>& table;
+    int at(long long sum) const { return table[sum]; }
+    void keep_min(long long sum, int length) { table[sum] = min(table[sum], length); }
+};
+
+#ifndef SPARSE_RATIO
+#define SPARSE_RATIO 16 // go sparse when K + 1 is this many times the sums
+#endif
+#define AUTO_TABLE 0
+#define DENSE_TABLE 1
+#define SPARSE_TABLE 2
+
+/*
+ * Everything one shops2 instance needs, so that several solvers can run at
+ * the same time (one per thread) and one solver can go through many
+ * instances without reallocating: lls and the sparse table only ever grow.
+ * The residents are only looked at during solve, never copied.
+ */
+class Shops2Solver
+{
+public:
+    int solve(span<const int> residents, long long K, int table = AUTO_TABLE);
+    int solve_plain(span<const int> residents, long long K);
+    int solve_parallel(span<const int> residents, long long K, int threads);
+
+private:
+    span<const int> res; // residents
+    int N;
+    long long K; // can be way bigger than any house
+    vector<int> lls; // left lengths
+    sparse_lengths sparse;
+    vector<vector<int>> chunk_lls; // solve_parallel's tables, one per chunk
+
+    int seed(long long& sums);
+    long long residents_total() const;
+    template <bool Right = true, typename Lengths>
+    int bounded_sweep(Lengths& lengths, int ans, int from, int to);
+};
+
+/*
+ * reads one instance (N, K and the N houses) into residents and K,
+ * returns false when the input has run out
+ */
+inline bool read_instance(IntReader& in, vector<int>& residents, long long& K)
+{
+    int N;
+    if (!(in >> N >> K)) return false;
+    residents.resize(N);
+    for (int& r : residents) in >> r;
+    return bool(in);
+}
+
+/*
+ * the instance in an inputN.bin of corpus_convert, file has to be an open
+ * CORPUS_SHOPS2 case (see common/corpus.hpp). Nothing is copied: residents
+ * points into the file and is only good while file is around.
+ */
+inline void load_instance(const CorpusFile& file, span<const int>& residents, long long& K)
+{
+    CorpusArray<int32_t> houses = file.section<int32_t>(0);
+    residents = span<const int>(houses.data, houses.size());
+    K = file.size(1);
+}
+
+inline int Shops2Solver::solve_plain(span<const int> residents, long long target)
+{
+    res = residents;
+    N = res.size();
+    K = target;
+    if (K == 0) return 0; // Solution is just 0
+    lls.assign(K + 1,N + 1); // list of lengths...
+    // if lls[S] = x that means that the minimum length
+    // subsequence on the 'left' side of what we are checking
+    // that has sum equal to S has length x.
+
+    // this is a useful initialization, can be used when we
+    // find a subsequence with sum = K in the right half...
+    lls[0] = 0; // you can always get a subsequence with
+                // sum equal to 0 if it's length is 0.
+
+    long long sum;
+    int ans = N + 1; // initialize ans to some value bigger
+    // than anything possible, so that we can decrease it whenever we
+    // find a possible solution, if at the end it has not decreased that
+    // means we found no solutions...
+    for(int p = 0; p < N; ++p) // p is a partitioner of
+                               // the residencies into 2 parts
+    { // in the end we provide a rough drawing of why the use of
+      // p, f, r indexes is enough to check all possible values...
+        sum = 0;
+        for(int f = p - 1; f >= 0; --f) // first half
+        {
+            sum += res[f];
+            if (sum > K) break; // the rest will be at least as big
+            lls[sum] = min(lls[sum],p - f); // this is the length
+        }
+
+        // now we are gonna check for ANY possible subsequence on the
+        // right side...
+        sum = 0;
+        for(int r = p; r < N; ++r) // right half (last half)
+        {
+            sum += res[r];
+            if (sum > K) break; // the rest will be at least as big
+            ans = min(ans, lls[K - sum] + r - p + 1);
+        }
+    }
+    if (ans == N + 1) ans = -1;
+    return ans;
+}
+/*-----------------------------------------------------------------
+           ---------------------------->(direction of p)
+ (direction of f)<------- |------->(direction of r)
+                 _________ ______
+                |         |      |
+res     = [ _...|_ ...  _ |_ ..._|..._  ]
+indexes =   0    f     p-1 p    r    N-1
+
+*********************************************************
+when we are at partioning point p then every left hand side sum
+of residents we find is gonna end at index p-1 and every right
+hand side sum of residents we find starts at index p. How do we
+manage to check right hand side [p,...,r] part with all the left
+parts? We don't but by keeping the minimum length of some sum
+we found on the left side through all the iterations we've made so
+far we make sure that we check all possible solutions.
+-------------------------------------------------------------------
+*/
+
+
+/*
+ * the p-sweep of solve_plain(), with two bounds on its inner loops:
+ * - a right hand side that is not shorter than ans can't help, so the
+ *   r loop also stops there
+ * - a left hand side needs at least one more house on the right, so the
+ *   f loop only keeps lengths up to ans - 2 (ans only gets smaller, so
+ *   whatever we skip would never have been used later either)
+ * It only goes over the partition points p in [from, to), and without
+ * Right it just fills lengths, which is how solve_parallel builds its
+ * per-chunk tables.
+ */
+template <bool Right, typename Lengths>
+inline int Shops2Solver::bounded_sweep(Lengths& lengths, int ans, int from, int to)
+{
+    long long sum;
+    for(int p = from; p < to; ++p)
+    {
+        sum = 0;
+        for(int f = p - 1; f >= 0 && p - f < ans - 1; --f)
+        {
+            sum += res[f];
+            if (sum > K) break;
+            lengths.keep_min(sum, p - f);
+        }
+        if (!Right) continue;
+
+        sum = 0;
+        for(int r = p; r < N && r - p + 1 < ans; ++r)
+        {
+            sum += res[r];
+            if (sum > K) break;
+            ans = min(ans, lengths.at(K - sum) + r - p + 1);
+        }
+    }
+    return ans;
+}
+
+/*
+ * the shortest single subsequence with sum exactly K (N + 1 if there is
+ * none), found with two pointers, and in sums the number of subsequences
+ * with sum <= K
+ */
+inline int Shops2Solver::seed(long long& sums)
+{
+    int ans = N + 1;
+    long long sum = 0;
+    sums = 0;
+    for (int f = 0, r = 0; r < N; ++r)
+    {
+        sum += res[r];
+        while (sum > K) sum -= res[f++];
+        if (sum == K) ans = min(ans, r - f + 1);
+        sums += r - f + 1; // subsequences ending at r with sum <= K
+    }
+    return ans;
+}
+
+// every resident of every house, the biggest sum anything can have
+inline long long Shops2Solver::residents_total() const
+{
+    long long total = 0;
+    for (int r : res) total += r;
+    return total;
+}
+
+/*
+ * Same answer as solve_plain(), usually much faster.
+ * All the resident counts are positive, so every start has at most one
+ * end with sum exactly K and a single two-pointer sweep over res finds the
+ * shortest subsequence with sum K in O(N) (a house with exactly K
+ * residents shows up here as length 1). That is already a possible
+ * answer that bounds the sweep (see bounded_sweep), so both loops take
+ * min(ans, houses until the sum passes K) steps.
+ * The same sweep also counts the subsequences with sum <= K. Neither that
+ * count nor all the residents together can be smaller than the number of
+ * distinct sums the left side can ever store, so the smaller of the two is
+ * the estimate. When K + 1 is a lot bigger than that, lls would be mostly
+ * empty (or not fit in memory at all), so the sparse table is used instead.
+ * A K past all the residents together has no answer and no table at all.
+ */
+inline int Shops2Solver::solve(span<const int> residents, long long target, int table)
+{
+    res = residents;
+    N = res.size();
+    K = target;
+    if (K == 0) return 0;
+    long long total = residents_total();
+    if (K > total) return -1;
+
+    long long sums;
+    int ans = seed(sums);
+    long long distinct = min(sums, total);
+
+    if (table == AUTO_TABLE)
+        table = (K + 1 > SPARSE_RATIO * distinct) ? SPARSE_TABLE : DENSE_TABLE;
+    if (table == SPARSE_TABLE)
+    {
+        sparse.reset(min(distinct + 1, 1LL << 20), N + 1);
+        sparse.keep_min(0, 0);
+        ans = bounded_sweep(sparse, ans, 0, N);
+    }
+    else
+    {
+        lls.assign(min(K, total) + 1,N + 1); // same as in solve_plain()
+        lls[0] = 0;
+        dense_lengths lengths{lls};
+        ans = bounded_sweep(lengths, ans, 0, N);
+    }
+    if (ans == N + 1) ans = -1;
+    return ans;
+}
+
+/*
+ * solve() spread over threads. The sweep only carries lls from one p to
+ * the next, and what it carries for a chunk of p's is just the min of
+ * what every earlier chunk put in it. So:
+ * 1. every chunk fills a table of its own with only the left hand sides
+ *    its p's would add (in parallel)
+ * 2. a prefix-min over the chunks turns table c into everything chunks
+ *    0..c added, i.e. the lls chunk c + 1 starts with (in parallel over
+ *    slices of the sums)
+ * 3. every chunk runs the full sweep over its p's from that table (in
+ *    parallel), and the answer is the best of the chunks
+ * Each chunk can prune with the seed ans, the best any answer could need.
+ * The left loops run twice and there are threads tables of K + 1, so when
+ * solve() would go sparse this is just solve().
+ */
+inline int Shops2Solver::solve_parallel(span<const int> residents, long long target, int threads)
+{
+    res = residents;
+    N = res.size();
+    K = target;
+    if (K == 0) return 0;
+    long long total = residents_total();
+    if (K > total) return -1;
+
+    long long sums;
+    int ans = seed(sums);
+    threads = min(threads, N);
+    if (threads < 2 || K + 1 > SPARSE_RATIO * min(sums, total))
+        return solve(residents, target);
+
+    auto run = [threads](auto work) {
+        vector<thread> pool;
+        for (int t = 0; t < threads; ++t) pool.emplace_back(work, t);
+        for (thread& t : pool) t.join();
+    };
+    auto chunk_from = [&](int c) { return (int)((long long)N * c / threads); };
+
+    chunk_lls.resize(threads);
+    run([&](int c) { // 1
+        chunk_lls[c].assign(K + 1, N + 1);
+        dense_lengths lengths{chunk_lls[c]};
+        bounded_sweep<false>(lengths, ans, chunk_from(c), chunk_from(c + 1));
+    });
+    run([&](int t) { // 2
+        long long to = (K + 1) * (t + 1) / threads;
+        for (int c = 1; c < threads; ++c)
+            for (long long s = (K + 1) * t / threads; s < to; ++s)
+                chunk_lls[c][s] = min(chunk_lls[c][s], chunk_lls[c - 1][s]);
+    });
+    vector<int> answers(threads);
+    run([&](int c) { // 3
+        // chunk c works in the table it starts from, nobody else needs it
+        // anymore, and chunk 0 takes the last one (which nobody needs)
+        vector<int>& table = chunk_lls[c ? c - 1 : threads - 1];
+        if (c == 0) table.assign(K + 1, N + 1);
+        table[0] = 0;
+        dense_lengths lengths{table};
+        answers[c] = bounded_sweep(lengths, ans, chunk_from(c), chunk_from(c + 1));
+    });
+
+    for (int a : answers) ans = min(ans, a);
+    if (ans == N + 1) ans = -1;
+    return ans;
+}
+
+} // namespace shops2
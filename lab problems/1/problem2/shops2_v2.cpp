@@ -1,111 +1,161 @@
-#include <iostream>
-#include <vector>
 #include <fstream>
+#include <chrono>
+#include <string>
+#include <atomic>
+#include "shops2.hpp"
+#include "../../common/timing.hpp"
 
 using namespace std;
-
-int N,K;
-vector<int> res; // residents
-vector<int> lls; // left lengths
+using namespace shops2;
 
 /*
- * this function is used just to get the input
- * and set-up variables N,K,res which we need
- * to solve the problem  
+ * The pool behind the batch modes: one thread per solver, each takes the
+ * next job index until all count of them are done, so a slow instance
+ * doesn't hold up the others. The solvers outlive the calls, which is what
+ * lets them keep their tables from one batch to the next.
  */
-inline int get_input(istream& in)
+template <typename Work>
+void run_pool(vector<Shops2Solver>& solvers, int count, Work work)
 {
-    in >> N >> K;
-    if (K == 0) return 0; // Solution is just 0
-    res.resize(N); // give this vector the proper size
-    int new_residents;
-    for(int i = 0; i < N; ++i)
-    {
-        in >> new_residents;
-        if (new_residents == K)
-            return 1; // if a house has K residents then
-                      // we've found the solution and we
-                      // can stop
-        res[i] = new_residents;
-    }
-    return 2;
+    atomic<int> next(0);
+    vector<thread> pool;
+    for (Shops2Solver& solver : solvers)
+        pool.emplace_back([&]{
+            for (int job; (job = next++) < count; )
+                work(solver, job);
+        });
+    for (thread& t : pool) t.join();
 }
 
-inline int solve()
+// the first inputs of the corpus at once on threads solvers, checked against the outputs
+void batch_corpus(int inputs, int threads)
 {
-    lls = vector<int>(K + 1,N + 1); // list of lengths...
-    // if lls[S] = x that means that the minimum length
-    // subsequence on the 'left' side of what we are checking
-    // that has sum equal to S has length x.
+    vector<vector<int>> residents(inputs);
+    vector<long long> K(inputs);
+    vector<int> answers(inputs);
+    for (int i = 0; i < inputs; ++i)
+    {
+        IntReader file(("shops2/input" + to_string(i + 1) + ".txt").c_str());
+        read_instance(file, residents[i], K[i]);
+    }
 
-    // this is a useful initialization, can be used when we
-    // find a subsequence with sum = K in the right half...
-    lls[0] = 0; // you can always get a subsequence with
-                // sum equal to 0 if it's length is 0.
+    vector<Shops2Solver> solvers(threads);
+    double ms = timed_millis([&]{
+        run_pool(solvers, inputs, [&](Shops2Solver& solver, int i){
+            answers[i] = solver.solve(residents[i], K[i]);
+        });
+    });
 
-    int ans = N + 1, sum; // initialize ans to some value bigger
-    // than anything possible, so that we can decrease it whenever we
-    // find a possible solution, if at the end it has not decreased that
-    // means we found no solutions...
-    for(int p = 0; p < N; ++p) // p is a partitioner of
-                               // the residencies into 2 parts
-    { // in the end we provide a rough drawing of why the use of
-      // p, f, r indexes is enough to check all possible values...
-        sum = 0;
-        for(int f = p - 1; f >= 0; --f) // first half
+    int wrong = 0;
+    for (int i = 0; i < inputs; ++i)
+    {
+        ifstream solution("shops2/output" + to_string(i + 1) + ".txt");
+        int res;
+        solution >> res;
+        if (answers[i] != res)
         {
-            sum += res[f];
-            if (sum > K) break; // the rest will be at least as big
-            lls[sum] = min(lls[sum],p - f); // this is the length
+            ++wrong;
+            cout << "Input " << i + 1 << " wrong: " << answers[i] << " instead of " << res << endl;
         }
+    }
+    cout << inputs - wrong << "/" << inputs << " right on " << threads
+         << " threads in " << ms << " ms" << endl;
+}
 
-        // now we are gonna check for ANY possible subsequence on the
-        // right side...
-        sum = 0;
-        for(int r = p; r < N; ++r) // right half (last half)
-        {
-            sum += res[r];
-            if (sum > K) break; // the rest will be at least as big
-            ans = min(ans, lls[K - sum] + r - p + 1);
-        }
+/*
+ * instances back to back on stdin (N K and the houses, as many as there
+ * are), answers on stdout in the same order. They are read in blocks, so
+ * memory stays bounded however long the stream is.
+ */
+void batch_stream(int threads)
+{
+    const int block = 1024;
+    vector<vector<int>> residents(block);
+    vector<long long> K(block);
+    vector<int> answers(block);
+    vector<Shops2Solver> solvers(threads);
+    IntReader in; // standard input
+    for (int count = block; count == block; )
+    {
+        for (count = 0; count < block && read_instance(in, residents[count], K[count]); ++count);
+        run_pool(solvers, count, [&](Shops2Solver& solver, int i){
+            answers[i] = solver.solve(residents[i], K[i]);
+        });
+        for (int i = 0; i < count; ++i) cout << answers[i] << '\n';
     }
-    if (ans == N + 1) ans = -1;
-    return ans;
 }
-/*-----------------------------------------------------------------
-           ---------------------------->(direction of p)
- (direction of f)<------- |------->(direction of r)
-                 _________ ______
-                |         |      |
-res     = [ _...|_ ...  _ |_ ..._|..._  ]
-indexes =   0    f     p-1 p    r    N-1
 
-*********************************************************
-when we are at partioning point p then every left hand side sum
-of residents we find is gonna end at index p-1 and every right
-hand side sum of residents we find starts at index p. How do we
-manage to check right hand side [p,...,r] part with all the left
-parts? We don't but by keeping the minimum length of some sum
-we found on the left side through all the iterations we've made so
-far we make sure that we check all possible solutions.
--------------------------------------------------------------------
-*/
+/*
+ * solve_parallel on N houses with 1 resident each and K = N / 2: K is well
+ * under the N residents, so nothing returns before the sweep, and the
+ * answer is K (any K houses in a row). seed finds that right away, after
+ * which the left and right loops of every p run to the K - 1 houses that
+ * bound allows and never break earlier, so every thread count does the
+ * whole O(N * K) sweep. Prints the time and speedup for 1, 2, 4 ... up to
+ * max_threads threads.
+ */
+void bench_parallel(int N, int max_threads)
+{
+    vector<int> residents(N, 1);
+    long long K = N / 2;
+    Shops2Solver solver;
+    int expected = solver.solve_plain(residents, K);
+    if (expected <= 0)
+    {
+        cerr << "N = " << N << " gives no answer to time, it needs at least 2 houses" << endl;
+        return;
+    }
+    double single = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        int ans;
+        double ms = timed_millis([&]{ ans = solver.solve_parallel(residents, K, threads); });
+        if (threads == 1) single = ms;
+        cout << threads << " threads: " << ms << " ms, speedup " << single / ms
+             << ((ans == expected) ? "" : " (wrong answer)") << endl;
+    }
+}
 
-int main()
+/*
+ * no arguments: reads how many inputs to check and times solve_plain and
+ *               both tables of solve on each of them
+ * --batch T:    reads how many inputs, batch_corpus across T threads
+ * --stream T:   instances from stdin across T threads
+ * --parallel N [max_threads]: bench_parallel (max_threads defaults to 32)
+ */
+int main(int argc, char* argv[])
 {
+    if (argc > 2 && string(argv[1]) == "--parallel")
+    {
+        bench_parallel(stoi(argv[2]), argc > 3 ? stoi(argv[3]) : 32);
+        return 0;
+    }
+    if (argc > 2 && string(argv[1]) == "--stream")
+    {
+        batch_stream(stoi(argv[2]));
+        return 0;
+    }
+
+    Shops2Solver solver;
+    vector<int> residents;
+    long long K;
     int inputs;
     cin >> inputs;
+    if (argc > 2 && string(argv[1]) == "--batch")
+    {
+        batch_corpus(inputs, stoi(argv[2]));
+        return 0;
+    }
     for(int i = 1; i <= inputs; ++i)
     {
-        ifstream file("shops2/input" + to_string(i) + ".txt");
+        IntReader file(("shops2/input" + to_string(i) + ".txt").c_str());
+        read_instance(file, residents, K);
 
-        int ans;
-        switch(get_input(file)){
-            case 0: ans = 0; break;
-            case 1: ans = 1; break;
-            default: ans = solve();
-        }
-        file.close();
+        int ans, dense, sparse;
+        double plain_ms = timed_millis([&]{ ans = solver.solve_plain(residents, K); });
+        double dense_ms = timed_millis([&]{ dense = solver.solve(residents, K, DENSE_TABLE); });
+        double sparse_ms = timed_millis([&]{ sparse = solver.solve(residents, K, SPARSE_TABLE); });
+        int parallel = solver.solve_parallel(residents, K, 4);
 
         ifstream solution("shops2/output" + to_string(i) + ".txt");
         int res;
@@ -116,6 +166,32 @@ int main()
             std::cout << "Solution found: " << ans << std::endl;
             std::cout << "Actual solution: " << res << std::endl;
         }
+        if (dense != ans || sparse != ans || parallel != ans)
+            std::cout << "Bounded sweep found: " << dense << " (dense), " << sparse << " (sparse), "
+                      << parallel << " (parallel)" << std::endl;
+        cout << "  plain " << plain_ms << " ms, dense " << dense_ms
+             << " ms, sparse " << sparse_ms << " ms" << endl;
     }
+
+    // and one K that lls could never hold (20 GB): big houses, K = 5 * 10^9
+    residents.resize(200000);
+    K = 5000000000LL;
+    unsigned long long seed = 1;
+    for (int& r : residents)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        r = 1 + (seed >> 33) % 1000000000;
+    }
+    int huge;
+    double huge_ms = timed_millis([&]{ huge = solver.solve(residents, K); });
+    cout << "N = " << residents.size() << ", K = " << K << ": " << huge << " in " << huge_ms << " ms" << endl;
+
+    // and a K bigger than all the residents together, where the count of
+    // sums <= K (N^2 / 2 here) says nothing about how big lls has to be
+    residents.assign(200000, 1);
+    K = 1000000000LL;
+    huge_ms = timed_millis([&]{ huge = solver.solve(residents, K); });
+    cout << "N = " << residents.size() << ", K = " << K << ", 1 each: " << huge << " in " << huge_ms << " ms"
+         << ((huge == -1) ? "" : " (wrong answer)") << endl;
     return 0;
 }
@@ -5,6 +5,7 @@
 #include <stack>
 #include <fstream>
 #include <climits>
+#include "../../common/int_reader.hpp"
 
 using namespace std;
 
@@ -21,7 +22,7 @@ public:
     vector<Num> P;
     vector<Num> S;
 
-    Graph(istream& in)
+    Graph(IntReader& in)
     {
         in >> N;
         adj.resize(N);
@@ -237,7 +238,7 @@ int main(){
     cin >> inputs;
 
     for (int i = 1; i <= inputs; ++i) {
-        ifstream file("relay/input" + to_string(i) + ".txt");
+        IntReader file(("relay/input" + to_string(i) + ".txt").c_str());
 
         Graph H(file);
         DAG G(H);
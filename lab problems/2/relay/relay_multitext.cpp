@@ -1,247 +1,85 @@
 #include <iostream>
 #include <vector>
 #include <utility>
-#include <stack>
-#include <climits>
 #include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <ext/stdio_filebuf.h>
+#include <ext/stdio_sync_filebuf.h>
+#include "relay.hpp"
+#include "../../common/timing.hpp"
 
 using namespace std;
+using namespace relay;
 
-using Big = unsigned long long;
-using Num = unsigned;
-using Neighbor = pair<Num, Big>;
-using Adj = vector<vector<Neighbor> >;
-
-/* A very simple Graph structure to hold the input */
-class Graph
+/* how many integers there are and their sum, with any reader that has >> */
+template <typename In>
+pair<Big, Big> read_all(In& in)
 {
-public:
-    Num N;
-    Adj adj;
-    vector<Num> P;
-    vector<Num> S;
-
-    /* used to read input and create an appropriate
-        * Graph. Node names are in [0..N-1] */
-    Graph(istream& in)
+    Big count = 0, sum = 0, x;
+    while (in >> x)
     {
-        in >> N;
-        adj.resize(N);
-        P.resize(N);
-        S.resize(N);
-        P[0] = S[0] = 0;
-
-        Num u, v;
-        Big w;
-
-        for (Num i = 0; i < N - 1; ++i)
-        {
-            in >> u >> v >> w;
-            --u; // naming scheme!
-            --v; // naming scheme!
-            adj[u].push_back(make_pair(v,w));
-            adj[v].push_back(make_pair(u,w));
-            // update adjecency lists
-        }
-
-        for (Num i = 1; i < N; ++i)
-        {
-            in >> P[i] >> S[i];
-        }
+        ++count;
+        sum += x;
     }
-};
+    return make_pair(count, sum);
+}
 
-/* We'll need to turn our Tree into a DAG (always doable for a tree)
- * to help us with this problem */
-class DAG
+/* run as relay_multitext --parse: reads every integer of the first inputs
+ * inputs three ways and prints the MB/s of each. The first two are the
+ * streambufs libstdc++ puts under cin: stdio's by default and a filebuf of
+ * its own after sync_with_stdio(false). The third is IntReader. */
+int bench_parse(int inputs)
 {
-public:
-    Num N;
-    Adj adj;
-    vector<Num> P;
-    vector<Num> S;
-
-    /* DFS to create the DAG */
-    DAG(Graph& G)
-    {
-        N = G.N;
-        adj.resize(N);
-        P = G.P; // copy
-        S = G.S; // copy
-
-        vector<bool> visited(N, false);
-
-        stack<Num> stack;
-        stack.push(0);
-
-        Num s;
-        while (!stack.empty())
-        {
-            s = stack.top();
-            stack.pop();
-
-            if (visited[s]) continue;
-
-            visited[s] = true;
-
-            for (auto x : G.adj[s])
-            {
-                if (!visited[x.first])
-                {
-                    adj[s].push_back(x); // copy of x
-                    stack.push(x.first);
-                }
-            }
-        } 
-    }
-
-    /* used for checking errors and stuff */
-    void printDAG()
-    {
-        for (Num i = 0; i < N; ++ i)
-            cout << P[i] << "  ";
-        cout << endl;
-
-        for (Num i = 0; i < N; ++ i)
-            cout << S[i] << "  ";
-        cout << endl;
-
-        for (Num v = 0; v < N; ++v) {
-            cout << "\nAdjecency list of vertex " << v << "\nhead";
-
-            for (auto x: adj[v])
-            cout << "-> " << "(" << get<0>(x) << ", " << get<1>(x) << ")";
-        }
-        cout << endl;
-    }
-
-    /* Topological sort needed to find shortest paths */
-    stack<Num> topologicalSort()
-    {
-        stack<Num> tS;
-        vector<bool> visited(N,false);
-        stack<pair<Num, bool> > stack;
-
-        stack.push(make_pair(0,false));
-
-        /* this algorithm implements the idea with the departure
-         * times without actually counting them, but with a the
-         * boolean added to the pairs we use in the stack */
-        while(!stack.empty())
-        {
-            Num s = stack.top().first;
-            bool done = stack.top().second;
-            stack.pop();
-
-            if (done)
-            {
-                tS.push(s);
-                continue;
-            }
-
-            if (visited[s]) continue;
-
-            visited[s] = true;
-            stack.push(make_pair(s, true));
-
-            for (auto x : adj[s])
-            {
-                if (!visited[x.first])
-                {
-                    stack.push(make_pair(x.first,false));
-                }
-            }
-        }
-        return tS;
-    }
-
-    /* this DAG is a tree, we do not need the visited array in
-     * this DFS. What this function does is put an edge from
-     * a node to all reachable nodes in the tree */
-    void helpCompleteDAG(Num s)
-    {
-        stack<Neighbor> stack; // we are gonna be carrying weight
-
-        stack.push(make_pair(s, 0));
-
-        while(!stack.empty())
-        {
-            Num next = stack.top().first;
-            Big carry_weight = stack.top().second;
-            stack.pop();
-
-            for(auto x : adj[next])
-            {
-                Num node = x.first;
-                Big edge_weight = x.second;
-                stack.push(make_pair(node, carry_weight + edge_weight));
-                if (carry_weight != 0) // if the carry weight is 0, the
-                //edge already exists in the DAG, no need to add it manually
-                    adj[s].push_back(make_pair(node, carry_weight + edge_weight));
+    const char* names[3] = { "cin", "cin, sync_with_stdio(false)", "IntReader" };
+    double seconds[3] = { 0, 0, 0 };
+    double megabytes = 0;
+    bool agree = true;
+    for (int i = 1; i <= inputs; ++i) {
+        string path = "relay/input" + to_string(i) + ".txt";
+        IntReader warm(path.c_str()); // only so that every reader finds it in the page cache
+        if (!warm)
+            break; // no such input
+        pair<Big, Big> expected = read_all(warm);
+        megabytes += ifstream(path, ios::binary | ios::ate).tellg() / 1e6;
+
+        for (int r = 0; r < 3; ++r) {
+            FILE* f = fopen(path.c_str(), "r");
+            pair<Big, Big> got;
+            auto start = chrono::high_resolution_clock::now();
+            if (r == 0) {
+                __gnu_cxx::stdio_sync_filebuf<char> buf(f);
+                istream in(&buf);
+                got = read_all(in);
+            } else if (r == 1) {
+                __gnu_cxx::stdio_filebuf<char> buf(f, ios::in);
+                istream in(&buf);
+                got = read_all(in);
+            } else {
+                IntReader in(path.c_str());
+                got = read_all(in);
             }
+            seconds[r] += seconds_since(start);
+            fclose(f);
+            agree = agree && got == expected;
         }
     }
-
-    /* the classic shortest path algorithm on DAGS, but first
-     * we topologically sort the nodes and then complete the DAG with
-     * the above function so that we include the 'detours' */
-    vector<Big> shortestPathOnDAG()
-    {
-        stack<Num> tS, tS_complete_DAG;
-        tS = tS_complete_DAG = topologicalSort(); // copies
-
-        while(!tS_complete_DAG.empty())
-        {
-            Num s = tS_complete_DAG.top();
-            tS_complete_DAG.pop();
-            helpCompleteDAG(s);
-        }
-        // now we're ready to do the shortest path algorithm
-        vector<Big> D(N, ULLONG_MAX);
-        D[0] = 0;
-
-        while(!tS.empty())
-        {
-            Num u = tS.top();
-            tS.pop();
-
-            for (auto x : adj[u])
-            {
-                Num v = x.first;
-                Big w = x.second;
-                if (D[v] > D[u] + P[v] + S[v] * w)
-                    D[v] = D[u] + P[v] + S[v] * w;
-            } // slight modification to shortest path to accomodate
-              // our problem
-        }
-        return D;
-    }
-};
-
-
-/*
-int main(){
-    Graph H(cin); // O(N)
-    DAG G(H); // O(N)
-
-    vector<Big> D = G.shortestPathOnDAG();
-    // O(N) + O(N^2) + O(N^2) = O(N^2)
-
-    for (Num i = 1; i < G.N - 1; ++i) // O(N)
-        cout << D[i] << " ";
-    cout << D[G.N - 1] << endl;
-
+    for (int r = 0; r < 3; ++r)
+        cout << names[r] << ": " << megabytes / seconds[r] << " MB/s" << endl;
+    cout << megabytes << " MB, " << (agree ? "same" : "different") << " numbers" << endl;
+    return 0;
 }
-// In most methods we use an implementation of DFS, which does
-// a particular function on the Graph, which we've seen in lectures
-*/
 
-int main(){
+int main(int argc, char* argv[]){
     int inputs;
     cin >> inputs;
 
+    if (argc > 1 && string(argv[1]) == "--parse")
+        return bench_parse(inputs);
+
     for (int i = 1; i <= inputs; ++i) {
-        ifstream file("relay/input" + to_string(i) + ".txt");
+        IntReader file(("relay/input" + to_string(i) + ".txt").c_str());
 
         Graph H(file);
         DAG G(H);
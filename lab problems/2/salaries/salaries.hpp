@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <climits> // just for the INT_MIN, INT_MAX
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include "../../common/int_reader.hpp"
+#include "../../common/corpus.hpp"
+#include "../../common/radix_sort.hpp"
+
+namespace salaries
+{
+using namespace std;
+
+/*
+ * Idea behind this algorithm:
+ * 
+ * Suppose Q = (q1, ..., qN) = [p1, ..., pl + x, ..., pr + x, pr+1, ..., pN]
+ * is the modifiend sequence with maximum LIS.
+ *
+ * case 1: answer with 0 <= x <= k
+ * 
+ * elements of Q with index > r that belong in the LIS are larger than
+ * all previous elements so adding x to them won't change the LIS.
+ * In the resulting Q:
+ * elements of Q with index >= l that belong in the LIS are larger than
+ * all previous elements so adding (k - x) to them won't change the LIS.
+ * 
+ * so Q' = [p1, ..., pl + k, ..., pN + k] will give us the same LIS.
+ * 
+ * case 2: answer with -k <= x < 0
+ * 
+ * elements of Q with index < l that belong in the LIS are smaller than
+ * all following elements so adding -x to them won't change the LIS.
+ * In the resulting Q:
+ * elements of Q with index > r that belong in the LIS are larger than
+ * all previous elements so adding (k + x) to them won't change the LIS.
+ * 
+ * So Q' = [p1, ..., pl, ..., pr, pr+1 + k, ... pN + k] gives the same LIS.
+ * 
+ * We can find the answer as follows:
+ * for every position find the largest IS up to that position and
+ * add the length of the largest IS from that position given that
+ * the last element of the first is smaller than the first element
+ * of the later + K.
+ * 
+ */
+
+/* read the input, this function is O(N)*/
+template <typename T = int>
+vector<T> read_input(IntReader& in, int& N, T& K)
+{
+    in >> N >> K;
+    vector<T> p(N);
+    for (int i = 0; i < N; ++i)
+        in >> p[i];
+    return p;
+}
+
+/* the same from an inputN.bin of corpus_convert, file has to be an open
+ * CORPUS_SALARIES case (see common/corpus.hpp) */
+template <typename T = int>
+vector<T> load_input(const CorpusFile& file, int& N, T& K)
+{
+    CorpusArray<int64_t> p = file.section<int64_t>(0);
+    N = p.size();
+    K = file.size(1);
+    return vector<T>(p.begin(), p.end());
+}
+
+
+/* When we want the actual modification and not just its length we run LIS
+ * with Witness = true and hand it one of these. pred[i] is the index of the
+ * element right before pi in the LIS which ends at pi (-1 if there is none).
+ * best is the index where the raised part starts and best_prev is the last
+ * element we keep from the left part (-1 if we keep nothing from it). */
+struct LIS_witness {
+    vector<int> pred;
+    int best = -1;
+    int best_prev = -1;
+};
+
+/* a < x + K, written so that x + K is never computed in T (K >= 0).
+ * For types narrower than long long we just do the sum in long long. */
+template <typename T>
+bool below_raised(T a, T x, T K)
+{
+    if constexpr (sizeof(T) < sizeof(long long))
+        return (long long) a < (long long) x + K;
+    else {
+        using U = make_unsigned_t<T>;
+        return a < x || U(a) - U(x) < U(K); // a >= x here, so a - x fits in U
+    }
+}
+
+/* this function is a modified Longest Increasing Subsequence
+ * algorithm based on the lecture slides and examples of our subject 
+ * This is the usual implementation of the LIS O(NlogN) but with some
+ * extra features */
+template <bool Witness = false, typename T = int>
+pair <int, vector<int> > LIS(vector<T>& v, T K,
+                            const vector<int>& LIS_start_at = vector<int>(1,INT_MIN),
+                            LIS_witness* witness = nullptr,
+                            const vector<int>* raised = nullptr)
+{
+    /* raised is only given when v holds ranks from compress() below, then
+     * raised[i] takes the place of v[i] + K and K is not used at all */
+    bool flag = false;
+    if (LIS_start_at.size() == 1 && LIS_start_at[0] == INT_MIN) flag = true;
+    /* This flag is used to inform us if the function has been supplied with a
+     * vector that contains the LIS which starts at each possible element of v */
+
+    vector<T> tail(v.size()); // tail is the equivalent of the 'm' array in the lecture slides.
+
+    vector<int> LIS_ending_at(v.size()); // this array will store the following information:
+    // if L = LIS_ending_at[i] then the LIS which ends at pi has length L in the standard LIS version
+
+    vector<int> tail_at; // tail_at[j] is the index in v of the value stored in tail[j],
+    // we only need it (and pay for it) when we are asked for a witness
+    if constexpr (Witness) {
+        tail_at.resize(v.size());
+        witness->pred.assign(v.size(), -1);
+    }
+    
+    int max_length = 0; // this is the result in the modified version, otherwise, doesn't do anything useful
+    int length = 0; // the current length of an LIS which we have not found...
+
+    typename vector<T>::iterator s, t, it;
+    for (int i = 0; i < v.size(); ++i) {
+        
+        s = tail.begin();
+        t = tail.begin() + length;
+
+        if (raised)
+            it = lower_bound(s, t, (T) (*raised)[i]);
+        else
+            it = lower_bound(s, t, v[i], [K](const T& a, const T& x) { return below_raised(a, x, K); });
+        // the binary search in the 'm' array done with a standard function
+        // iterator is the location of the first element >= to v[i] + K
+        
+        if (!flag) { // if we have been given the LIS_start_at array we should be updating the max_length
+            int candidate = ((int) distance(s, it)) + LIS_start_at[i];
+            // this would be length1 + length2 - 1, however, the -1 is emitted because the distance() function
+            // returns (length1 - 1)
+            if (candidate > max_length) {
+                max_length = candidate;
+                if constexpr (Witness) { // remember where this happened, the left part ends right before it
+                    witness->best = i;
+                    witness->best_prev = (it == s) ? -1 : tail_at[distance(s, it) - 1];
+                }
+            }
+        }
+        
+        it = lower_bound(s, t, v[i]); // if we are running the algorithm with a K > 0, we want the next
+        // iterations to use the 'm' array with v[i] included, since we are looking for the element which
+        // is the first element of the array we'll increase by K.
+        // if we are running this with K = 0 then the result will be the exact same as in the previous
+        // lower_bound execution
+
+        if (it == tail.begin() + length) // we have unlocked a new length!
+            ++length;
+
+        *it = v[i]; // update the length to the new minimum value of the final element for that length LIS
+
+        LIS_ending_at[i] = distance(tail.begin(), it) + 1;
+
+        if constexpr (Witness) { // pi extends the LIS that currently ends at the previous length
+            int position = distance(tail.begin(), it);
+            witness->pred[i] = (position == 0) ? -1 : tail_at[position - 1];
+            tail_at[position] = i;
+        }
+    } //important to note: iterators of vectors are random access iterators, that means that distance() and 
+      // lower_bound() are optimized. They run in O(1) and O(log(last - first)) = O(logN) respectively.
+    return make_pair(max_length, LIS_ending_at);
+    // when we use it as standard LIS we will be taking the second return value
+    // and using that we will run the modified LIS to get the first return value which will be our answer.
+}
+
+/* Coordinate compression, for values (or values + K) that don't fit in an int.
+ * radix_sort (common/radix_sort.hpp) puts the indices in sorted order and we
+ * hand out dense ranks in [0, D) while walking it. raised[i] is
+ * the number of distinct values < p[i] + K, so rank < raised[i] exactly when
+ * value < p[i] + K and the LIS on the ranks gives the same answer.
+ * O(N) time (8 passes at most), the result is two ints per element. */
+template <typename T>
+void compress(const vector<T>& p, T K, vector<int>& rank, vector<int>& raised)
+{
+    int N = p.size();
+    vector<make_unsigned_t<T>> key(N);
+    vector<int> index(N);
+    for (int i = 0; i < N; ++i) {
+        key[i] = radix_key(p[i]);
+        index[i] = i;
+    }
+    radix_sort(key, index);
+
+    vector<T> distinct; // the different values, sorted
+    rank.resize(N);
+    for (int i = 0; i < N; ++i) {
+        if (i == 0 || key[i] != key[i - 1])
+            distinct.push_back(radix_value<T>(key[i]));
+        rank[index[i]] = distinct.size() - 1;
+    }
+
+    vector<int> raised_rank(distinct.size()); // same thing, per distinct value
+    int j = 0;
+    for (int a = 0; a < distinct.size(); ++a) { // p[i] + K grows with p[i], so j only moves forward
+        while (j < distinct.size() && below_raised(distinct[j], distinct[a], K))
+            ++j;
+        raised_rank[a] = j;
+    }
+    raised.resize(N);
+    for (int i = 0; i < N; ++i)
+        raised[i] = raised_rank[rank[i]];
+}
+
+/* Rebuild the answer from the witnesses of the two LIS runs, O(N).
+ * forward is the witness of the modified LIS on p and backward the one of the
+ * standard LIS on the reversed/negated input. We raise [l, r] (1-based) by x
+ * and return the indices (0-based) of the chosen increasing subsequence. */
+inline vector<int> rebuild(const LIS_witness& forward, const LIS_witness& backward,
+                    int N, long long K, int& l, int& r, long long& x)
+{
+    // from case 1 above: the best answer always raises a whole suffix by K
+    l = forward.best + 1;
+    r = N;
+    x = K;
+
+    vector<int> indices;
+    for (int j = forward.best_prev; j != -1; j = forward.pred[j])
+        indices.push_back(j); // left part, walked from its end
+    reverse(indices.begin(), indices.end());
+
+    // the LIS ending at N - 1 - best in the reversed input is the LIS starting
+    // at best in p, its predecessors there are the next elements here
+    for (int j = N - 1 - forward.best; j != -1; j = backward.pred[j])
+        indices.push_back(N - 1 - j);
+    return indices;
+}
+
+/* If every p[i] + K (and -p[i]) fits in an int we run on the values themselves,
+ * otherwise we run on their ranks and the LIS never sees anything bigger than N.
+ * Fills p and k with what the LIS runs on and returns the shift argument of LIS
+ * (nullptr for the values themselves, raised for the ranks). */
+inline const vector<int>* prepare(const vector<long long>& values, long long K, vector<int>& p, int& k, vector<int>& raised)
+{
+    bool fits = K <= INT_MAX;
+    for (long long value : values)
+        fits = fits && -INT_MAX <= value && value <= INT_MAX - K;
+
+    if (fits) {
+        p.assign(values.begin(), values.end());
+        k = K;
+        return nullptr;
+    }
+    k = 0;
+    compress(values, K, p, raised);
+    return &raised;
+}
+
+/* just the answer: the two LIS runs of main, without its witness */
+inline int max_length(const vector<long long>& values, long long K)
+{
+    vector<int> p, raised;
+    int k;
+    const vector<int>* shift = prepare(values, K, p, k, raised);
+    vector<int> r(p.rbegin(), p.rend()); // reversed and negated
+    for (int& ri: r) ri = -ri;
+    vector<int> LIS_start_at = LIS(r,0).second;
+    reverse(LIS_start_at.begin(),LIS_start_at.end());
+    return LIS(p, k, LIS_start_at, nullptr, shift).first;
+}
+
+} // namespace salaries
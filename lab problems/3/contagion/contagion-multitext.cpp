@@ -1,158 +1,282 @@
-/*
-In this program the random numbers we create are also going to be called "trials".
-Imagine a Graph with N vertices. As we create more and more trials this graph has
-more and more edges added to it. We need to maintain the size of its components.
-
-Each time we add a new edge we check the size of the component it belongs to and if
-this size is big enough we terminate.
-
-To maintain the components with good complexity we use a very simple implementation of
-a disjoint-set data structure using Union by size in order to keep track of component
-sizes too.
-
-The implementation of this data structure is from the wikipedia page about Disjoint-set data structures
-*/
 #include <vector>
 #include <iostream>
 #include <unordered_set>
+#include <array>
+#include <string>
 #include <chrono>
 #include <fstream>
-
+#include "contagion.hpp"
+#include "../../common/timing.hpp"
 
 using namespace std;
+using namespace contagion;
 
-#define MAX_INPUT_SIZE 63 // usefull number in this problem
-using big = unsigned long long; // used in an unordered set to keep track of multiple edges
-
-// ----------- DJS - start --------------
-class subset {
-public:
-    int parent;
-    int size;
-};
+// one whole run with the given set for the edges (and telemetry, if it gets one),
+// returns { edges, multi_edges, loops }
+template <typename Set, typename Sink = NoTelemetry>
+array<int, 3> simulate(int N, int F, const vector<int>& seeds, Set doublicates, Sink&& telemetry = Sink()) {
+    Counts counts = spread(N, seeds, doublicates, reached(target_of(N, F)), telemetry);
+    return { counts.edges, counts.multi_edges, counts.loops };
+}
 
-// path-halving version of find function
-int Find(vector<subset>& subsets, int i) {
-    while (subsets[i].parent != i) {
-        i = subsets[i].parent = subsets[subsets[i].parent].parent;
+// the same run with each kind of edge set, timed. Returns the answer of the
+// first one and complains if the others disagree
+array<int, 3> compare_sets(int N, int F, const vector<int>& seeds) {
+    array<int, 3> ans, flat, bloom;
+    double time_unordered = timed_seconds([&] { ans = simulate(N, F, seeds, unordered_set<big>()); });
+    double time_flat = timed_seconds([&] { flat = simulate(N, F, seeds, FlatEdgeSet<false>(expected_edges(N, F))); });
+    double time_bloom = timed_seconds([&] { bloom = simulate(N, F, seeds, FlatEdgeSet<true>(expected_edges(N, F))); });
+    if (flat != ans || bloom != ans) {
+        cout << "The edge sets disagree!" << endl;
     }
-    return i;
+    std::cout << "Time taken by unordered_set: " << time_unordered << " seconds, flat set: " << time_flat
+              << " seconds, flat set with Bloom filter: " << time_bloom << " seconds" << std::endl;
+
+    // and how much of that was just making the trials
+    big pairs = big(ans[0]) + ans[1] + ans[2];
+    big checksum = 0;
+    double time_trials = timed_seconds([&] {
+        TrialGenerator trials(seeds, N);
+        for (big k = 0; k < pairs; ++k) {
+            auto [first, second] = trials.next();
+            checksum += first ^ second;
+        }
+    });
+    std::cout << "Time taken by the generator alone: " << time_trials << " seconds (checksum " << checksum << ")" << std::endl;
+    return ans;
 }
 
-// Union by size
-void Union(vector<subset>& subsets, int x, int y) {
-    // replace nodes by roots
-    x = Find(subsets, x);
-    y = Find(subsets, y);
+/*
+count trials from the block generator against the plain one trial at a time %
+recurrence, checking they are the same and printing trials per second of each
+(and of just making blocks, without handing the trials out)
+*/
+void bench_generator(int N, big count, const vector<int>& seeds) {
+    count -= count % 2; // the block generator only hands out pairs
+    big plain_sum = 0, block_sum = 0;
+    double time_plain = timed_seconds([&] {
+        int ring[MAX_INPUT_SIZE + 1];
+        copy(seeds.begin(), seeds.end(), ring);
+        for (big i = 0; i < count; ++i) {
+            if (i >= MAX_INPUT_SIZE) {
+                ring[i & MAX_INPUT_SIZE] = (ring[(i + 1) & MAX_INPUT_SIZE] + ring[(i + 33) & MAX_INPUT_SIZE]) % N;
+            }
+            plain_sum = plain_sum * 31 + ring[i & MAX_INPUT_SIZE];
+        }
+    });
+    double time_block = timed_seconds([&] {
+        TrialGenerator trials(seeds, N);
+        for (big i = 0; i < count; i += 2) {
+            auto [first, second] = trials.next();
+            block_sum = block_sum * 31 + first;
+            block_sum = block_sum * 31 + second;
+        }
+    });
+    double time_make = timed_seconds([&] {
+        TrialGenerator trials(seeds, N);
+        for (big i = 0; i < count; i += TRIAL_BLOCK) {
+            trials.make_block();
+        }
+    });
+    cout << ((plain_sum == block_sum) ? "same trials" : "different trials!") << endl;
+    cout << "plain: " << count / time_plain / 1e6 << " million trials per second, blocks: "
+         << count / time_block / 1e6 << " million trials per second, making the blocks alone: "
+         << count / time_make / 1e6 << " million trials per second" << endl;
+}
 
-    if (x == y) return;
+/*
+one percolation curve for the input against 100 separate runs for F = 1..100,
+timing both
+*/
+void check_curve(int test, int N, const vector<int>& seeds) {
+    vector<Counts> curve;
+    double time_curve = timed_seconds([&] { curve = percolation_curve(N, seeds, FlatEdgeSet<true>(expected_edges(N, 100))); });
 
-    if (subsets[x].size < subsets[y].size) {
-        int z = x;
-        x = y;
-        y = z;
-    } // we always merge the small set to the big set
+    bool correct = true;
+    double time_runs = timed_seconds([&] {
+        for (int f = 1; f <= 100; ++f) {
+            array<int, 3> ans = simulate(N, f, seeds, FlatEdgeSet<true>(expected_edges(N, f)));
+            correct = correct && ans == array<int, 3>{ curve[f].edges, curve[f].multi_edges, curve[f].loops };
+        }
+    });
+    cout << "Test " << test << ": " << ((correct) ? "correct curve" : "wrong curve") << endl;
+    std::cout << "Time taken by the curve: " << time_curve << " seconds, by 100 runs: " << time_runs << " seconds" << std::endl;
+}
 
-    subsets[y].parent = x;
-    subsets[x].size += subsets[y].size;
+// writes the first pairs pairs of trials for these seeds to path, as a replay log.
+// Returns false if it couldn't write all of it
+bool write_log(const char* path, int N, const vector<int>& seeds, big pairs) {
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+    TrialGenerator trials(seeds, N);
+    vector<uint32_t> chunk;
+    bool written = true;
+    for (big k = 0; k < pairs && written; ++k) {
+        auto [first, second] = trials.next();
+        chunk.push_back(first);
+        chunk.push_back(second);
+        if (chunk.size() == (1 << 20) || k + 1 == pairs) {
+            written = fwrite(chunk.data(), sizeof(uint32_t), chunk.size(), out) == chunk.size();
+            chunk.clear();
+        }
+    }
+    return fclose(out) == 0 && written;
 }
-// ------------- DJS - end -------------------
 
-// get inputs
-vector<int> get_input(istream& in, int& N, int& F) {
-    in >> N >> F;
+/*
+the run for these seeds, generated and then replayed from a log of its trials at
+path (with ten times the pairs the run needs, which the replay shouldn't touch),
+printing both times. Returns whether they agree (and the log could be replayed).
+*/
+bool check_replay(int N, int F, const vector<int>& seeds, const char* path) {
+    array<int, 3> ans;
+    double time_generated = timed_seconds([&] { ans = simulate(N, F, seeds, FlatEdgeSet<true>(expected_edges(N, F))); });
+    if (!write_log(path, N, seeds, 10 * (big(ans[0]) + ans[1] + ans[2]))) {
+        std::cout << path << ": can't write the log there" << std::endl;
+        return false;
+    }
 
-    vector<int> trials(MAX_INPUT_SIZE);
-    for (int i = 0; i < MAX_INPUT_SIZE; ++i) {
-        in >> trials[i];
+    Counts counts;
+    const char* error = nullptr;
+    double time_replayed = timed_seconds([&] {
+        ReplaySource log(path, N);
+        DisjointSet people_sets(N + 1);
+        FlatEdgeSet<true> doublicates(expected_edges(N, F));
+        counts = spread(people_sets, doublicates, log, reached(target_of(N, F)));
+        error = log.what();
+    });
+    if (error) {
+        std::cout << path << ": " << error << std::endl;
+        return false;
     }
-    return trials;
+    std::cout << "Time taken generating: " << time_generated << " seconds, replaying: " << time_replayed << " seconds" << std::endl;
+    return ans == array<int, 3>{ counts.edges, counts.multi_edges, counts.loops };
 }
 
-// add a new trial to our inputs vector
-void set_input(vector<int>& trials, int i, int N) {
-    if (i >= MAX_INPUT_SIZE) {
-        if (i >= trials.size()) { // resize if needed
-            trials.resize(trials.size() + N);
+/*
+times one run for N people to F% with random seeds, without telemetry and, when it
+is compiled in, with a record every 1, 1000 and 10^6 trials written to path
+*/
+void bench_telemetry(int N, int F, const vector<int>& seeds, const char* path) {
+    array<int, 3> ans;
+    double plain = timed_seconds([&] { ans = simulate(N, F, seeds, FlatEdgeSet<true>(expected_edges(N, F))); });
+    cout << "no telemetry: " << plain << " seconds" << endl;
+#ifdef CONTAGION_TELEMETRY
+    for (big every : { 1ULL, 1000ULL, 1000000ULL }) {
+        Telemetry telemetry;
+        if (!telemetry.open(path, every, N)) {
+            cout << path << ": can't write telemetry there" << endl;
+            return;
         }
-        trials[i] = (trials[i - MAX_INPUT_SIZE] + trials[i - MAX_INPUT_SIZE/2]) % N; 
+        array<int, 3> sampled;
+        double time = timed_seconds([&] { sampled = simulate(N, F, seeds, FlatEdgeSet<true>(expected_edges(N, F)), telemetry); });
+        ifstream written(path, ios::binary | ios::ate);
+        cout << "every " << every << " trials: " << time << " seconds (" << (time / plain - 1) * 100 << "% more), "
+             << written.tellg() / sizeof(TelemetryRecord) << " records" << ((sampled == ans) ? "" : ", different answer!") << endl;
     }
+#else
+    (void)path;
+    cout << "telemetry is compiled out (build with -DCONTAGION_TELEMETRY)" << endl;
+#endif
 }
 
-// used in our unordered_set as a hash function. takes edge = (x, y) and maps it to a unique integer
-big turn_2d_to_1d(int x, int y) {
-    big a = x;
-    big b = y;
-    if (x > y) {
-        a = y;
-        b = x;
-    } // a is always the small value, b is always the large value
-    return ((a + b)*(a + b) + 3*a + b) / 2; // we've seen this in Discrete Maths
+/*
+runs random seed vectors for N people to F% with run_batch on 1, 2, 4 ... up to
+max_threads threads, checking them against one simulate each and printing runs
+per second and the speedup over one thread
+*/
+void bench_batch(int N, int F, int runs, int max_threads) {
+    vector<vector<int>> seed_sets(runs, vector<int>(MAX_INPUT_SIZE));
+    big state = 1;
+    for (vector<int>& seeds : seed_sets) {
+        for (int& seed : seeds) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            seed = (state >> 33) % N;
+        }
+    }
+
+    bool correct = true;
+    for (int k = 0; k < runs; ++k) {
+        array<int, 3> ans = simulate(N, F, seed_sets[k], FlatEdgeSet<true>(expected_edges(N, F)));
+        Counts counts = run_batch(N, F, { seed_sets[k] }, 1)[0];
+        correct = correct && ans == array<int, 3>{ counts.edges, counts.multi_edges, counts.loops };
+    }
+    cout << ((correct) ? "batch runs match" : "batch runs differ!") << endl;
+
+    double single = 0;
+    vector<Counts> results;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double time = timed_seconds([&] { results = run_batch(N, F, seed_sets, threads); });
+        if (threads == 1) single = time;
+        cout << threads << " threads: " << runs / time << " runs per second, speedup " << single / time << endl;
+    }
+    print_statistics(results);
 }
 
-int main() {
+/*
+reads how many tests to run from stdin, or with --big N F runs one random
+input of N people (63 random seeds) to the F% target instead.
+--generator N count times count trials for N people with both generators.
+--batch N F runs max_threads runs bench_batch.
+--telemetry N F path runs bench_telemetry.
+--replay N F path runs check_replay, and --replay path does that for every test instead.
+With --curve it reads how many tests too but checks their percolation curves.
+*/
+int main(int argc, char* argv[]) {
+    if (argc > 3 && (string(argv[1]) == "--big" || string(argv[1]) == "--generator" || string(argv[1]) == "--telemetry" || string(argv[1]) == "--replay")) {
+        int N = stoi(argv[2]);
+        vector<int> seeds(MAX_INPUT_SIZE);
+        big state = 1;
+        for (int& seed : seeds) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            seed = (state >> 33) % N;
+        }
+        if (string(argv[1]) == "--replay" && argc > 4) {
+            cout << ((check_replay(N, stoi(argv[3]), seeds, argv[4])) ? "replay matches" : "replay differs!") << endl;
+            return 0;
+        }
+        if (string(argv[1]) == "--telemetry" && argc > 4) {
+            bench_telemetry(N, stoi(argv[3]), seeds, argv[4]);
+            return 0;
+        }
+        if (string(argv[1]) == "--generator") {
+            bench_generator(N, stoull(argv[3]), seeds);
+            return 0;
+        }
+        int F = stoi(argv[3]);
+        array<int, 3> ans = compare_sets(N, F, seeds);
+        cout << ans[0] << " " << ans[1] << " " << ans[2] << "\n";
+        return 0;
+    }
+
+    if (argc > 5 && string(argv[1]) == "--batch") {
+        bench_batch(stoi(argv[2]), stoi(argv[3]), stoi(argv[4]), stoi(argv[5]));
+        return 0;
+    }
+
+    bool curves = argc > 1 && string(argv[1]) == "--curve";
+    const char* replay = (argc > 2 && string(argv[1]) == "--replay") ? argv[2] : nullptr;
     int tries;
     cin >> tries;
 
     for (int i = 1; i <= tries; ++i) {
-        ifstream file("contagion/input" + to_string(i) + ".txt");
+        IntReader file(("contagion/input" + to_string(i) + ".txt").c_str());
         ifstream solution("contagion/output" + to_string(i) + ".txt");
 
-        auto start = std::chrono::high_resolution_clock::now();
-
         // get program inputs
-        int N, F, target;
-        vector<int> trials = get_input(file, N, F);
-        target = N*F/100 + (N*F % 100 != 0); // we want at least N*F/100 so we include the modulo arithmetic
-        // inputs have been formatted.
-        // N = number of people, target = number of people which is big enough to meet the required percentage
-
-        // Union find vector for our collection of people!
-        vector<subset> subsets(N + 1);
-        for (int i = 0; i < N + 1; ++i) {
-            subsets[i].parent = i;
-            subsets[i].size = 1;
-        }
-
-        int edges = 0; // how many edges we've added to the graph
-        int loops = 0; // how many loops there are
-        int multi_edges = 0; // how many multiple edges there are
-        unordered_set<big> doublicates; // keeps track of edges to check for doublicates
-        int trial = 0;
-        while(true) { // trials[trial] and trials[trial + 1] are gonna be the new edge
-            int first = trial;
-            int second = trial + 1;
-
-            set_input(trials, first, N);
-            set_input(trials, second, N);
-
-            first = trials[first]; // person that corresponds to first trial
-            second = trials[second]; // person that corresponds to second trial
-
-            big one_dim = turn_2d_to_1d(first, second);
-            if (first == second) {
-                ++loops; // we have looped! first, second are the same person
-            }
-            else if (doublicates.count(one_dim)) { // we have seen this edge already
-                ++multi_edges; // it is a doublicate
-            }
-            else {
-                ++edges; // new edge found
-                doublicates.insert(one_dim); // add it to the doublicates set
-                Union(subsets, first, second); // create the new component
-            }
+        int N, F;
+        vector<int> seeds = get_input(file, N, F);
+        // N = number of people, F = percentage of them the biggest component has to reach
 
-            first = Find(subsets, first);   // be careful, sizes of components are guaranteed to be stored correctly at the root of that component
-            second = Find(subsets, second); // so we get the root!
-
-            if (subsets[first].size >= target || subsets[second].size >= target) {
-                break; // a component has hit the target size!
-            }
-            trial += 2;
+        if (curves) {
+            check_curve(i, N, seeds);
+            continue;
         }
-
-        int ans[] = { edges, multi_edges, loops };
-        string messages[] = {"pairs", "multiple edges", "loops"};
+        if (replay) {
+            cout << "Test " << i << ": " << ((check_replay(N, F, seeds, replay)) ? "replay matches" : "replay differs!") << endl;
+            continue;
+        }
+        array<int, 3> ans = compare_sets(N, F, seeds);
 
         cout << "Test " << i << ": ";
         int sol;
@@ -162,15 +286,6 @@ int main() {
             correct = correct && (ans[i] == sol);
         }
         cout << ((correct) ? "correct answer" : "wrong answer") << endl;
-
-        auto end = std::chrono::high_resolution_clock::now();
-        
-        // Calculate the duration and display it in stdout
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        double seconds = duration.count() / 1000000.0; // convert microseconds to seconds
-        std::cout << "Time taken by program: " << seconds << " seconds" << std::endl;
-    
-        cout << endl;    
+        cout << endl;
     }
-}
\ No newline at end of file
+}
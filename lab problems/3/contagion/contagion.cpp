@@ -1,144 +1,110 @@
-/*
-In this program the random numbers we create are also going to be called "trials".
-Imagine a Graph with N vertices. As we create more and more trials this graph has
-more and more edges added to it. We need to maintain the size of its components.
-
-Each time we add a new edge we check the size of the component it belongs to and if
-this size is big enough we terminate.
-
-To maintain the components with good complexity we use a very simple implementation of
-a disjoint-set data structure using Union by size in order to keep track of component
-sizes too.
-
-The implementation of this data structure is from the wikipedia page about Disjoint-set data structures
-*/
-#include <vector>
-#include <iostream>
-#include <unordered_set>
+#include "contagion.hpp"
 
 using namespace std;
+using namespace contagion;
 
-#define MAX_INPUT_SIZE 63 // usefull number in this problem
-using big = unsigned long long; // used in an unordered set to keep track of multiple edges
-
-// ----------- DJS - start --------------
-class subset {
-public:
-    int parent;
-    int size;
-};
-
-// path-halving version of find function
-int Find(vector<subset>& subsets, int i) {
-    while (subsets[i].parent != i) {
-        i = subsets[i].parent = subsets[subsets[i].parent].parent;
-    }
-    return i;
-}
-
-// Union by size
-void Union(vector<subset>& subsets, int x, int y) {
-    // replace nodes by roots
-    x = Find(subsets, x);
-    y = Find(subsets, y);
-
-    if (x == y) return;
-
-    if (subsets[x].size < subsets[y].size) {
-        int z = x;
-        x = y;
-        y = z;
-    } // we always merge the small set to the big set
-
-    subsets[y].parent = x;
-    subsets[x].size += subsets[y].size;
-}
-// ------------- DJS - end -------------------
-
-// get inputs
-vector<int> get_input(int& N, int& F) {
-    cin >> N >> F;
-
-    vector<int> trials(MAX_INPUT_SIZE);
-    for (int i = 0; i < MAX_INPUT_SIZE; ++i) {
-        cin >> trials[i];
-    }
-    return trials;
-}
-
-// add a new trial to our inputs vector
-void set_input(vector<int>& trials, int i, int N) {
-    if (i >= MAX_INPUT_SIZE) {
-        if (i >= trials.size()) { // resize if needed
-            trials.resize(trials.size() + N);
+/*
+prints the edges, multiple edges and loops it took for a component to reach F% of
+the people. With --curve, F is ignored and all of F = 1..100 are printed instead,
+one line each: F edges multi_edges loops
+With --batch T there can be any number of seed vectors (63 numbers each) after the
+first one, all of them run on T threads: a line like the usual one per seed vector,
+in the same order, then a line of statistics over all of them. A seed vector cut
+short by the end of the input is an error.
+Built with CONTAGION_TELEMETRY, --telemetry FILE S writes the run's telemetry to FILE
+(a FILE that can't be written is an error, and so is --telemetry in a build without it).
+--replay FILE N F reads nothing from stdin and takes the pairs from the log in FILE
+(see ReplaySource) instead of the trials. If the log ends first, the counts are for
+all of it. A log that can't be read or has a person outside 0..N is an error.
+*/
+int main(int argc, char* argv[]) {
+    if (argc > 4 && string(argv[1]) == "--replay") {
+        int N = stoi(argv[3]), F = stoi(argv[4]);
+        ReplaySource log(argv[2], N);
+        if (!log) {
+            cerr << argv[2] << ": " << log.what() << endl;
+            return 1;
+        }
+        DisjointSet people_sets(N + 1);
+        FlatEdgeSet<true> doublicates(expected_edges(N, F));
+        Counts counts = spread(people_sets, doublicates, log, reached(target_of(N, F)));
+        if (!log) {
+            cerr << argv[2] << ": " << log.what() << endl;
+            return 1;
         }
-        trials[i] = (trials[i - MAX_INPUT_SIZE] + trials[i - MAX_INPUT_SIZE/2]) % N; 
+        cout << counts.edges << " " << counts.multi_edges << " " << counts.loops << "\n";
+        return 0;
     }
-}
-
-// used in our unordered_set as a hash function. takes edge = (x, y) and maps it to a unique integer
-big turn_2d_to_1d(int x, int y) {
-    big a = x;
-    big b = y;
-    if (x > y) {
-        a = y;
-        b = x;
-    } // a is always the small value, b is always the large value
-    return ((a + b)*(a + b) + 3*a + b) / 2; // we've seen this in Discrete Maths
-}
 
-int main() {
     // get program inputs
-    int N, F, target;
-    vector<int> trials = get_input(N, F);
-    target = N*F/100 + (N*F % 100 != 0); // we want at least N*F/100 so we include the modulo arithmetic
-    // inputs have been formatted.
-    // N = number of people, target = number of people which is big enough to meet the required percentage
-
-    // Union find vector for our collection of people!
-    vector<subset> subsets(N + 1);
-    for (int i = 0; i < N + 1; ++i) {
-        subsets[i].parent = i;
-        subsets[i].size = 1;
-    }
-
-    int edges = 0; // how many edges we've added to the graph
-    int loops = 0; // how many loops there are
-    int multi_edges = 0; // how many multiple edges there are
-    unordered_set<big> doublicates; // keeps track of edges to check for doublicates
-    int trial = 0;
-    while(true) { // trials[trial] and trials[trial + 1] are gonna be the new edge
-        int first = trial;
-        int second = trial + 1;
-
-        set_input(trials, first, N);
-        set_input(trials, second, N);
-
-        first = trials[first]; // person that corresponds to first trial
-        second = trials[second]; // person that corresponds to second trial
-
-        big one_dim = turn_2d_to_1d(first, second);
-        if (first == second) {
-            ++loops; // we have looped! first, second are the same person
+    int N, F;
+    IntReader in; // standard input
+    vector<int> seeds;
+    if (argc > 2 && string(argv[1]) == "--bin") { // an inputN.bin of corpus_convert instead
+        CorpusFile file(argv[2], CORPUS_CONTAGION);
+        if (!file) {
+            cerr << argv[2] << ": " << file.what() << endl;
+            return 1;
         }
-        else if (doublicates.count(one_dim)) { // we have seen this edge already
-            ++multi_edges; // it is a doublicate
+        seeds = load_input(file, N, F);
+    } else {
+        seeds = get_input(in, N, F);
+    }
+    // N = number of people, F = percentage of them the biggest component has to reach
+
+    bool with_telemetry = argc > 1 && string(argv[1]) == "--telemetry";
+#ifdef CONTAGION_TELEMETRY
+    Telemetry telemetry; // writes nothing unless it's opened
+    if (with_telemetry && argc < 4) {
+        cerr << "--telemetry needs a FILE and S" << endl;
+        return 1;
+    }
+    if (with_telemetry && !telemetry.open(argv[2], stoull(argv[3]), N)) {
+        cerr << argv[2] << ": can't write telemetry there" << endl;
+        return 1;
+    }
+#else
+    if (with_telemetry) {
+        cerr << "--telemetry is compiled out (build with -DCONTAGION_TELEMETRY)" << endl;
+        return 1;
+    }
+#endif
+
+    if (argc > 2 && string(argv[1]) == "--batch") {
+        vector<vector<int>> seed_sets = { seeds };
+        while (in >> seeds[0]) {
+            for (int i = 1; i < MAX_INPUT_SIZE; ++i) {
+                in >> seeds[i];
+            }
+            if (!in) { // the input ended in the middle of this one
+                cerr << "seed vector " << seed_sets.size() + 1 << " has fewer than "
+                     << MAX_INPUT_SIZE << " seeds" << endl;
+                return 1;
+            }
+            seed_sets.push_back(seeds);
         }
-        else {
-            ++edges; // new edge found
-            doublicates.insert(one_dim); // add it to the doublicates set
-            Union(subsets, first, second); // create the new component
+        vector<Counts> results = run_batch(N, F, seed_sets, stoi(argv[2]));
+        for (const Counts& counts : results) {
+            cout << counts.edges << " " << counts.multi_edges << " " << counts.loops << "\n";
         }
+        print_statistics(results);
+        return 0;
+    }
 
-        first = Find(subsets, first);   // be careful, sizes of components are guaranteed to be stored correctly at the root of that component
-        second = Find(subsets, second); // so we get the root!
-
-        if (subsets[first].size >= target || subsets[second].size >= target) {
-            break; // a component has hit the target size!
+    if (argc > 1 && string(argv[1]) == "--curve") {
+        vector<Counts> curve = percolation_curve(N, seeds, FlatEdgeSet<true>(expected_edges(N, 100)));
+        for (int f = 1; f <= 100; ++f) {
+            cout << f << " " << curve[f].edges << " " << curve[f].multi_edges << " " << curve[f].loops << "\n";
         }
-        trial += 2;
+        return 0;
     }
 
-    int ans[] = { edges, multi_edges, loops };
+#ifdef CONTAGION_TELEMETRY
+    Counts counts = spread(N, seeds, FlatEdgeSet<true>(expected_edges(N, F)), reached(target_of(N, F)), telemetry);
+#else
+    Counts counts = spread(N, seeds, FlatEdgeSet<true>(expected_edges(N, F)), reached(target_of(N, F)));
+#endif
+
+    int ans[] = { counts.edges, counts.multi_edges, counts.loops };
     cout << ans[0] << " " << ans[1] << " " << ans[2] << "\n";
-}
\ No newline at end of file
+}
@@ -0,0 +1,657 @@
+/*
+In this program the random numbers we create are also going to be called "trials".
+Imagine a Graph with N vertices. As we create more and more trials this graph has
+more and more edges added to it. We need to maintain the size of its components.
+
+Each time we add a new edge we check the size of the component it belongs to and if
+this size is big enough we terminate.
+
+To maintain the components with good complexity we use a very simple implementation of
+a disjoint-set data structure using Union by size in order to keep track of component
+sizes too.
+
+The implementation of this data structure is from the wikipedia page about Disjoint-set data structures
+*/
+#pragma once
+
+#include <vector>
+#include <iostream>
+#include <utility>
+#include <tuple>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "../../common/int_reader.hpp"
+#include "../../common/corpus.hpp"
+
+namespace contagion {
+using namespace std;
+
+#define MAX_INPUT_SIZE 63 // usefull number in this problem
+#define EDGE_BLOCK 16 // edges whose roots we look up together
+#define TRIAL_BLOCK 1024 // trials the generator makes at a time
+#define TELEMETRY_CHUNK 4096 // telemetry records written at a time
+#define REPLAY_AHEAD (64 << 20) // bytes of a replayed log to read ahead
+using big = unsigned long long; // used in a hash set to keep track of multiple edges
+
+// ----------- DJS - start --------------
+/*
+Union by size with path halving, with a single int per person: a root keeps minus
+the size of its component where everybody else keeps their parent.
+*/
+class DisjointSet {
+public:
+    explicit DisjointSet(int n = 0) : parent(n, -1) {}
+
+    // everybody on their own again, n people (keeps the memory)
+    void reset(int n) {
+        parent.assign(n, -1);
+#ifdef CONTAGION_TELEMETRY
+        merges = 0;
+#endif
+    }
+
+#ifdef CONTAGION_TELEMETRY
+    int merges = 0; // unions that really merged two components
+#endif
+
+    // path-halving version of find function
+    int find(int i) {
+        while (parent[i] >= 0) {
+            int up = parent[i];
+            if (parent[up] < 0) return up;
+            i = parent[i] = parent[up];
+        }
+        return i;
+    }
+
+    int size(int i) { return -parent[find(i)]; }
+
+    // Union by size, returns the root of the merged component and its size
+    pair<int, int> unite(int x, int y) {
+        // replace nodes by roots
+        x = find(x);
+        y = find(y);
+
+        if (x == y) return { x, -parent[x] };
+
+        if (parent[x] > parent[y]) {
+            swap(x, y);
+        } // we always merge the small set to the big set (sizes are negative)
+
+        parent[x] += parent[y];
+        parent[y] = x;
+#ifdef CONTAGION_TELEMETRY
+        ++merges;
+#endif
+        return { x, -parent[x] };
+    }
+
+    // roots[j] = find(people[j]) for a whole block of people. All the parents
+    // get prefetched first, so the misses overlap instead of coming one by one
+    void findMany(const int* people, int* roots, int count) {
+        for (int j = 0; j < count; ++j) {
+            __builtin_prefetch(&parent[people[j]]);
+        }
+        for (int j = 0; j < count; ++j) {
+            roots[j] = find(people[j]);
+        }
+    }
+
+private:
+    vector<int> parent;
+};
+// ------------- DJS - end -------------------
+
+// get inputs
+inline vector<int> get_input(IntReader& in, int& N, int& F) {
+    in >> N >> F;
+
+    vector<int> trials(MAX_INPUT_SIZE);
+    for (int i = 0; i < MAX_INPUT_SIZE; ++i) {
+        in >> trials[i];
+    }
+    return trials;
+}
+
+// the same from an inputN.bin of corpus_convert, file has to be an open CORPUS_CONTAGION case
+inline vector<int> load_input(const CorpusFile& file, int& N, int& F) {
+    N = file.size(0);
+    F = file.size(1);
+    return file.section<int32_t>(0).vector();
+}
+
+/*
+Yields the trials two at a time (first and second person of the next edge), making
+them TRIAL_BLOCK at a time ahead of whoever uses them. trials[i] only needs
+trials[i - 63] and trials[i - 31], so the block only has to start after the last
+63 trials, and any 8 trials in a row (lag 31 > 8) can be made with one AVX2 add.
+Once past the seeds both trials are < N, so the sum is < 2N and instead of % we
+just subtract N when it's big enough: min(sum, sum - N) as unsigned numbers picks
+sum - N exactly when it didn't wrap around. The seeds can be anything, so the
+first 63 trials after them still use %.
+*/
+class TrialGenerator {
+public:
+    TrialGenerator() : trials(MAX_INPUT_SIZE + TRIAL_BLOCK) {}
+
+    TrialGenerator(const vector<int>& seeds, int N) : TrialGenerator() {
+        reset(seeds, N);
+    }
+
+    // starts over from new seeds (keeps the memory)
+    void reset(const vector<int>& seeds, int people) {
+        copy(seeds.begin(), seeds.begin() + MAX_INPUT_SIZE, trials.begin());
+        given = 0;
+        end = MAX_INPUT_SIZE;
+        past_seeds = false;
+        N = people;
+    }
+
+    pair<int, int> next() {
+        if (end - given < 2) {
+            make_block();
+        }
+        given += 2;
+        return { trials[given - 2], trials[given - 1] };
+    }
+
+    // fills people with the next count pairs, returns count (trials never run out)
+    int take(int* people, int count) {
+        for (int j = 0; j < 2 * count; j += 2) {
+            tie(people[j], people[j + 1]) = next();
+        }
+        return count;
+    }
+
+    // makes the next TRIAL_BLOCK trials, after moving the last 63 ones to the front
+    void make_block() {
+        int keep = end - MAX_INPUT_SIZE;
+        copy(trials.begin() + keep, trials.begin() + end, trials.begin());
+        given -= keep;
+        end = MAX_INPUT_SIZE + TRIAL_BLOCK;
+
+        unsigned* out = reinterpret_cast<unsigned*>(trials.data()) + MAX_INPUT_SIZE;
+        int j = 0;
+        if (!past_seeds) {
+            for (; j < MAX_INPUT_SIZE; ++j) {
+                out[j] = (trials[j] + trials[MAX_INPUT_SIZE + j - MAX_INPUT_SIZE/2]) % N;
+            }
+            past_seeds = true;
+        }
+#if defined(__AVX2__)
+        __m256i n = _mm256_set1_epi32(N);
+        for (; j + 8 <= TRIAL_BLOCK; j += 8) {
+            __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((__m256i*)(out + j - MAX_INPUT_SIZE)),
+                                           _mm256_loadu_si256((__m256i*)(out + j - MAX_INPUT_SIZE/2)));
+            _mm256_storeu_si256((__m256i*)(out + j), _mm256_min_epu32(sum, _mm256_sub_epi32(sum, n)));
+        }
+#endif
+        for (; j < TRIAL_BLOCK; ++j) {
+            unsigned sum = out[j - MAX_INPUT_SIZE] + out[j - MAX_INPUT_SIZE/2];
+            out[j] = min(sum, sum - N);
+        }
+    }
+
+private:
+    vector<int> trials; // the last 63 trials, then the current block
+    int given = 0; // trials handed out of the vector so far
+    int end = MAX_INPUT_SIZE; // trials made so far (at first just the seeds)
+    bool past_seeds = false;
+    int N = 1;
+};
+
+/*
+Pairs from a recorded contact log instead of the generator: a file of packed
+little-endian uint32 (u, v) pairs, each one an edge like two trials would be. The
+file is memory-mapped rather than read, with a hint that it's read front to back,
+and the kernel is asked to start reading REPLAY_AHEAD bytes ahead of us as we go.
+Only what the run actually gets to is ever touched. A person outside 0..N ends the
+log there, like running out of pairs does. Like a CorpusFile it tests false when
+something went wrong (it can't open the file, or met such a person) and what()
+says what.
+*/
+class ReplaySource {
+public:
+    ReplaySource(const char* path, int people) : N(people) {
+        int fd = ::open(path, O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) < 0) {
+            error = "can't open the file";
+            if (fd >= 0) ::close(fd);
+            return;
+        }
+        bytes = info.st_size;
+        if (bytes > 0) {
+            void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                error = "can't map the file";
+                bytes = 0;
+            }
+            else {
+                pairs = reinterpret_cast<const uint32_t*>(mapped);
+                total = bytes / (2 * sizeof(uint32_t));
+                madvise(mapped, bytes, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd); // the mapping stays
+    }
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    ~ReplaySource() {
+        if (pairs) munmap(const_cast<uint32_t*>(pairs), bytes);
+    }
+
+    // fills people with up to count more pairs, returns how many there were
+    int take(int* people, int count) {
+        if (2 * sizeof(uint32_t) * (at + count) > advised && advised < bytes) {
+            size_t from = advised & ~size_t(4095); // madvise wants page boundaries
+            advised = min(bytes, advised + REPLAY_AHEAD);
+            madvise(const_cast<uint32_t*>(pairs) + from / sizeof(uint32_t), advised - from, MADV_WILLNEED);
+        }
+        int taken = 0;
+        for (; taken < count && at < total; ++taken, ++at) {
+            uint32_t u = pairs[2 * at], v = pairs[2 * at + 1];
+            if (u > uint32_t(N) || v > uint32_t(N)) {
+                error = "a pair has somebody who isn't one of the people";
+                total = at;
+                break;
+            }
+            people[2 * taken] = u;
+            people[2 * taken + 1] = v;
+        }
+        return taken;
+    }
+
+    explicit operator bool() const { return error == nullptr; }
+    const char* what() const { return error; }
+
+private:
+    const uint32_t* pairs = nullptr;
+    size_t bytes = 0; // size of the file
+    size_t total = 0; // pairs in it
+    size_t at = 0; // pairs handed out so far
+    size_t advised = 0; // bytes we've already asked the kernel for
+    int N;
+    const char* error = nullptr;
+};
+
+// used in our edge set as a hash function. takes edge = (x, y) and maps it to a unique integer
+inline big turn_2d_to_1d(int x, int y) {
+    big a = x;
+    big b = y;
+    if (x > y) {
+        a = y;
+        b = x;
+    } // a is always the small value, b is always the large value
+    return ((a + b)*(a + b) + 3*a + b) / 2; // we've seen this in Discrete Maths
+}
+
+// ----------- edge set - start --------------
+/*
+Set of edges (as turn_2d_to_1d keys) without unordered_set's allocation per edge
+and pointer chase per lookup: one flat array of keys with linear probing.
+- EMPTY marks a free slot, no edge key can be that big
+- the slot comes from a Fibonacci hash of the key
+- it is kept at most half full and doubles when it gets there
+
+With Bloom = true there is also a blocked Bloom filter in front of it: every key
+sets 4 bits inside one 64-byte block, so count() on an edge we never saw (almost
+all of them) usually costs one cache line and no probing at all.
+*/
+template <bool Bloom = false>
+class FlatEdgeSet {
+public:
+    static constexpr big EMPTY = ~0ULL;
+
+    explicit FlatEdgeSet(big expected = 1) {
+        reset(expected);
+    }
+
+    // empty again, with room for expected keys (keeps the memory when it's enough)
+    void reset(big expected) {
+        int bits = 4;
+        while ((1ULL << bits) < 2 * expected) ++bits;
+        keys.assign(1ULL << bits, EMPTY);
+        used = 0;
+        shape();
+    }
+
+    int count(big key) const {
+        if (Bloom && !maybe(key)) return 0;
+        for (big i = slot(key); ; i = (i + 1) & mask) {
+            if (keys[i] == key) return 1;
+            if (keys[i] == EMPTY) return 0;
+        }
+    }
+
+    void insert(big key) {
+        big i = slot(key);
+        for (; keys[i] != EMPTY; i = (i + 1) & mask) {
+            if (keys[i] == key) return;
+        }
+        keys[i] = key;
+        if (Bloom) remember(key);
+        if (2 * ++used > keys.size()) resize(shift_bits() + 1);
+    }
+
+private:
+    struct alignas(64) block { big words[8]; };
+
+    vector<big> keys;
+    vector<block> bloom; // one block per 32 slots, i.e. at least 16 bits per key
+    big mask;
+    int shift;
+    big used = 0;
+
+    int shift_bits() const { return 64 - shift; }
+
+    big slot(big key) const { return key * 0x9E3779B97F4A7C15ULL >> shift; }
+
+    // the Bloom filter needs bits that have nothing to do with the slot
+    static big mix(big key) {
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+    }
+
+    // the block a key goes to, from the bits above the ones its 4 positions
+    // (0..511 in there, 9 bits each) take: bits 0..35 are the positions
+    big block_of(big h) const { return h >> 36 & (bloom.size() - 1); }
+
+    bool maybe(big key) const {
+        big h = mix(key);
+        const block& b = bloom[block_of(h)];
+        for (int j = 0; j < 4; ++j) {
+            int bit = h >> (9 * j) & 511;
+            if (!(b.words[bit >> 6] >> (bit & 63) & 1)) return false;
+        }
+        return true;
+    }
+
+    void remember(big key) {
+        big h = mix(key);
+        block& b = bloom[block_of(h)];
+        for (int j = 0; j < 4; ++j) {
+            int bit = h >> (9 * j) & 511;
+            b.words[bit >> 6] |= 1ULL << (bit & 63);
+        }
+    }
+
+    // the hash and the (empty) filter for as many slots as keys has now
+    void shape() {
+        shift = 64 - __builtin_ctzll(keys.size());
+        mask = keys.size() - 1;
+        if (Bloom) bloom.assign(max<big>(keys.size() / 32, 1), block{});
+    }
+
+    // rebuilds the table, and the filter, with 2^bits slots
+    void resize(int bits) {
+        vector<big> old(1ULL << bits, EMPTY);
+        old.swap(keys);
+        shape();
+        for (big key : old) {
+            if (key == EMPTY) continue;
+            big i = slot(key);
+            while (keys[i] != EMPTY) i = (i + 1) & mask;
+            keys[i] = key;
+            if (Bloom) remember(key);
+        }
+    }
+};
+
+/*
+Roughly how many edges there are by the time a component has F% of the N people,
+so the set can be sized once. In a random graph with N people and m edges the
+biggest component has s*N of them where s = 1 - e^(-2ms/N), so m = -N ln(1-s) / 2s.
+F = 100 means everybody is connected, which takes about N ln N / 2 edges.
+If it's off the set just grows.
+*/
+inline big expected_edges(int N, int F) {
+    if (F >= 100) return N * (log(N) + 1) / 2;
+    if (F <= 0) return 1;
+    double s = F / 100.0;
+    return -N * log(1 - s) / (2 * s) + 1;
+}
+// ------------- edge set - end -------------------
+
+// how many of each kind of pair the trials have made so far
+struct Counts {
+    int edges = 0; // how many edges we've added to the graph
+    int multi_edges = 0; // how many multiple edges there are
+    int loops = 0; // how many loops there are
+};
+
+// people a component needs to have F% of all N of them
+inline int target_of(int N, int F) {
+    return N*F/100 + (N*F % 100 != 0); // we want at least N*F/100 so we include the modulo arithmetic
+}
+
+#ifdef CONTAGION_TELEMETRY
+/*
+Telemetry on how the giant component forms (build with -DCONTAGION_TELEMETRY and
+run with --telemetry FILE S). Every S trials (at most once per pair) one record
+gets appended to FILE, plus one at the end of the run, raw and little-endian:
+*/
+#pragma pack(push, 1)
+struct TelemetryRecord {
+    big trials; // trials made so far
+    unsigned largest; // people in the biggest component
+    unsigned components; // how many components there are
+    unsigned edges, multi_edges, loops; // the counts so far
+};
+#pragma pack(pop)
+
+/*
+The biggest component can only change through the pair that just grew one, so it's
+one max per pair, and the components are the people minus the unions that merged
+two of them (DisjointSet counts those). Records are written in chunks of
+TELEMETRY_CHUNK. Without a file to write to, sample() returns at once. A run only
+writes telemetry when it's handed one (see spread), so every run has its own.
+*/
+class Telemetry {
+public:
+    Telemetry() = default;
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    ~Telemetry() {
+        if (out) fclose(out);
+    }
+
+    // false if path can't be written
+    bool open(const char* path, big every, int people) {
+        if (out) fclose(out);
+        out = fopen(path, "wb");
+        if (!out) return false;
+        period = every;
+        next = every;
+        N = people;
+        largest = 1;
+        buffer.clear();
+        return true;
+    }
+
+    void sample(const Counts& counts, int grown, const DisjointSet& people_sets, bool last) {
+        if (!out) return;
+        largest = max(largest, grown);
+        big trials = 2 * (big(counts.edges) + counts.multi_edges + counts.loops);
+        if (trials < next && !last) return;
+
+        next = trials + period;
+        buffer.push_back({ trials, unsigned(largest), unsigned(N - people_sets.merges),
+                           unsigned(counts.edges), unsigned(counts.multi_edges), unsigned(counts.loops) });
+        if (buffer.size() == TELEMETRY_CHUNK || last) {
+            fwrite(buffer.data(), sizeof(TelemetryRecord), buffer.size(), out);
+            buffer.clear();
+        }
+        if (last) {
+            fclose(out);
+            out = nullptr;
+        }
+    }
+
+private:
+    FILE* out = nullptr;
+    big period = 1, next = 1;
+    int N = 0;
+    int largest = 1;
+    vector<TelemetryRecord> buffer;
+};
+#endif
+
+// what spread samples into when the run has no telemetry: nothing at all
+struct NoTelemetry {
+    void sample(const Counts&, int, const DisjointSet&, bool) {}
+};
+
+/*
+Adds the edges the trials make, in order, until done(grown, counts) says to stop
+(or a replayed log runs out). Trials is a TrialGenerator or a ReplaySource.
+It is asked after every pair, with grown = the size of the component that pair just
+made (0 if it wasn't a new edge) and the counts so far including that pair.
+Components only grow through unite, so that's the only size anybody needs.
+telemetry gets the same after every pair, and once more at the end of the log. It is
+the run's own (a Telemetry), or NoTelemetry, which compiles away.
+*/
+template <typename Set, typename Trials, typename Done, typename Sink = NoTelemetry>
+Counts spread(DisjointSet& people_sets, Set& doublicates, Trials& trials, Done done, Sink&& telemetry = Sink()) {
+    Counts counts;
+    int people[2 * EDGE_BLOCK], roots[2 * EDGE_BLOCK];
+    for (bool stop = false; !stop; ) {
+        // the next EDGE_BLOCK edges: people[j] and people[j + 1] for even j.
+        // their roots are found all at once, and stay right even after some of
+        // the unions below (a root from before is still in the same component)
+        int pairs = trials.take(people, EDGE_BLOCK);
+        if (pairs == 0) {
+            telemetry.sample(counts, 0, people_sets, true);
+            break;
+        }
+        people_sets.findMany(people, roots, 2 * pairs);
+
+        for (int j = 0; j < 2 * pairs && !stop; j += 2) {
+            int first = people[j], second = people[j + 1];
+            int grown = 0; // size of the component this edge made, if any
+
+            big one_dim = turn_2d_to_1d(first, second);
+            if (first == second) {
+                ++counts.loops; // we have looped! first, second are the same person
+            }
+            else if (doublicates.count(one_dim)) { // we have seen this edge already
+                ++counts.multi_edges; // it is a doublicate
+            }
+            else {
+                ++counts.edges; // new edge found
+                doublicates.insert(one_dim); // add it to the doublicates set
+                grown = people_sets.unite(roots[j], roots[j + 1]).second; // create the new component
+            }
+            stop = done(grown, counts);
+            telemetry.sample(counts, grown, people_sets, stop);
+        }
+    }
+    return counts;
+}
+
+// the same, for a single run that doesn't have the union-find and generator already
+template <typename Set, typename Done, typename Sink = NoTelemetry>
+Counts spread(int N, const vector<int>& seeds, Set doublicates, Done done, Sink&& telemetry = Sink()) {
+    // Union find for our collection of people!
+    DisjointSet people_sets(N + 1);
+    TrialGenerator trials(seeds, N);
+    return spread(people_sets, doublicates, trials, done, telemetry);
+}
+
+// the usual stopping point: a component with target people. Components only grow
+// through unite, so that's the only size to check, except when even a single
+// person is already enough
+inline auto reached(int target) {
+    return [target](int grown, const Counts&) {
+        return grown >= target || target <= 1;
+    };
+}
+
+/*
+One run for every seed vector, all with the same N and F, spread over threads
+workers. Every worker has a union-find, edge set and generator of its own that it
+just resets between runs, and takes the next seed vector whenever it's done with
+one, so a long run doesn't hold up the others.
+*/
+inline vector<Counts> run_batch(int N, int F, const vector<vector<int>>& seed_sets, int threads) {
+    vector<Counts> results(seed_sets.size());
+    atomic<size_t> next(0);
+    auto worker = [&] {
+        DisjointSet people_sets;
+        FlatEdgeSet<true> doublicates;
+        TrialGenerator trials;
+        for (size_t k; (k = next++) < seed_sets.size(); ) {
+            people_sets.reset(N + 1);
+            doublicates.reset(expected_edges(N, F));
+            trials.reset(seed_sets[k], N);
+            results[k] = spread(people_sets, doublicates, trials, reached(target_of(N, F)));
+        }
+    };
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    for (thread& t : pool) {
+        t.join();
+    }
+    return results;
+}
+
+// mean, min, max and quantiles (nearest rank) of how many edges the runs took
+inline void print_statistics(const vector<Counts>& results) {
+    vector<int> edges;
+    double mean = 0;
+    for (const Counts& counts : results) {
+        edges.push_back(counts.edges);
+        mean += counts.edges;
+    }
+    sort(edges.begin(), edges.end());
+    // the smallest value with at least a q fraction of the runs at or below it
+    auto quantile = [&](double q) {
+        size_t rank = max(ceil(q * edges.size()), 1.0);
+        return edges[min(rank, edges.size()) - 1];
+    };
+
+    cout << "runs " << results.size() << ", edges to threshold: mean " << mean / results.size()
+         << ", min " << edges.front() << ", 5% " << quantile(0.05) << ", 25% " << quantile(0.25)
+         << ", median " << quantile(0.5) << ", 75% " << quantile(0.75) << ", 95% " << quantile(0.95)
+         << ", max " << edges.back() << "\n";
+}
+
+/*
+The counts at the moment the biggest component first reaches target_of(N, F), for
+every F = 1..100 at once (curve[F]). That's one run up to F = 100, as the trials
+are the same whatever F is.
+*/
+template <typename Set>
+vector<Counts> percolation_curve(int N, const vector<int>& seeds, Set doublicates) {
+    vector<Counts> curve(101);
+    int largest = 1; // before any edge, every component has one person
+    int next = 1; // the first F we haven't reached yet
+    spread(N, seeds, doublicates, [&](int grown, const Counts& counts) {
+        largest = max(largest, grown);
+        for (; next <= 100 && largest >= target_of(N, next); ++next) {
+            curve[next] = counts;
+        }
+        return next > 100;
+    });
+    return curve;
+}
+
+} // namespace contagion
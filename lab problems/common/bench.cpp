@@ -0,0 +1,569 @@
+/*
+ * bench [options] [engine ...]
+ *
+ * The one benchmark for all the solvers. An engine is a problem's solver as a
+ * library (its .hpp) and its corpus directory; every inputN.txt found there,
+ * whatever N the corpus starts from, is a case. A case is parsed and solved
+ * W times untimed and then R times timed, the parse and the solve timed apart,
+ * and every answer is checked against outputN.txt. Each case runs in a child
+ * process, so its peak RSS is its own and a case that crashes or runs out of
+ * memory is reported instead of ending the run.
+ *
+ * options:
+ *   --warmup W    untimed runs of every case first (default 1)
+ *   --reps R      timed runs of every case (default 5)
+ *   --bin         load the inputN.bin of corpus_convert instead of parsing
+ *                 inputN.txt (cases without one are skipped)
+ *   --cases A-B   only the cases A to B (or just A)
+ *   --memory MB   limit every case's address space to MB megabytes
+ *   --json FILE   also write the results to FILE as JSON; with - the JSON goes
+ *                 to stdout and the table to stderr
+ *   --lab DIR     where the problem directories are (default: this tree's)
+ *
+ * engines: cereal shops2 salaries relay contagion shortcuts (default: all)
+ *
+ * The table has one line per case: the result (right, wrong, no output when
+ * there is no outputN.txt, or why the case didn't finish), the parse and the
+ * solve time as min / median / p95 in milliseconds and the peak RSS.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "int_reader.hpp"
+#include "corpus.hpp"
+#include "timing.hpp"
+#include "../1/problem1/cereal.hpp"
+#include "../1/problem2/shops2.hpp"
+#include "../2/salaries/salaries.hpp"
+#include "../2/relay/relay.hpp"
+#include "../3/contagion/contagion.hpp"
+#include "../3/shortcuts/shortcuts.hpp"
+
+#ifndef ALGO_LAB_DIR
+#define ALGO_LAB_DIR "lab problems"
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+using Answer = vector<long long>;
+using Solve = function<Answer()>; // solves the instance it holds
+
+struct Engine
+{
+    const char* name;
+    const char* corpus; // directory, relative to the lab directory
+    Solve (*parse)(const string& path, bool binary); // throws if it can't
+};
+
+// an inputN.bin of the right problem, open
+shared_ptr<CorpusFile> open_corpus(const string& path, CorpusProblem problem)
+{
+    auto file = make_shared<CorpusFile>(path.c_str(), problem);
+    if (!*file)
+        throw runtime_error(file->what());
+    return file;
+}
+
+Solve parse_cereal(const string& path, bool binary)
+{
+    int N, K;
+    pair<vector<int>, vector<long long>> input;
+    if (binary)
+        input = cereal::load_input(*open_corpus(path, CORPUS_CEREAL), N, K);
+    else
+    {
+        IntReader in(path.c_str());
+        input = cereal::read_input(in, N, K);
+    }
+    return [input = move(input), K]
+    {
+        int threads = max(1u, thread::hardware_concurrency());
+        return Answer{ cereal::maxMedian(input.first, K, input.second, threads) };
+    };
+}
+
+Solve parse_shops2(const string& path, bool binary)
+{
+    long long K;
+    if (binary) // the residents stay in the mapping
+    {
+        shared_ptr<CorpusFile> file = open_corpus(path, CORPUS_SHOPS2);
+        span<const int> residents;
+        shops2::load_instance(*file, residents, K);
+        return [file, residents, K]
+        {
+            shops2::Shops2Solver solver;
+            return Answer{ solver.solve(residents, K) };
+        };
+    }
+    vector<int> residents;
+    IntReader in(path.c_str());
+    shops2::read_instance(in, residents, K);
+    return [residents = move(residents), K]
+    {
+        shops2::Shops2Solver solver;
+        return Answer{ solver.solve(residents, K) };
+    };
+}
+
+Solve parse_salaries(const string& path, bool binary)
+{
+    int N;
+    long long K;
+    vector<long long> values;
+    if (binary)
+        values = salaries::load_input(*open_corpus(path, CORPUS_SALARIES), N, K);
+    else
+    {
+        IntReader in(path.c_str());
+        values = salaries::read_input(in, N, K);
+    }
+    return [values = move(values), K]
+    {
+        return Answer{ salaries::max_length(values, K) };
+    };
+}
+
+Solve parse_relay(const string& path, bool binary)
+{
+    shared_ptr<relay::Graph> H;
+    if (binary)
+        H = make_shared<relay::Graph>(*open_corpus(path, CORPUS_RELAY));
+    else
+    {
+        IntReader in(path.c_str());
+        H = make_shared<relay::Graph>(in);
+    }
+    return [H]
+    {
+        relay::DAG G(*H);
+        vector<relay::Big> D = G.shortestPathOnDAG();
+        return Answer(D.begin() + 1, D.end()); // what relay prints
+    };
+}
+
+Solve parse_contagion(const string& path, bool binary)
+{
+    int N, F;
+    vector<int> seeds;
+    if (binary)
+        seeds = contagion::load_input(*open_corpus(path, CORPUS_CONTAGION), N, F);
+    else
+    {
+        IntReader in(path.c_str());
+        seeds = contagion::get_input(in, N, F);
+    }
+    return [seeds = move(seeds), N, F]
+    {
+        using namespace contagion;
+        Counts counts = spread(N, seeds, FlatEdgeSet<true>(expected_edges(N, F)), reached(target_of(N, F)));
+        return Answer{ counts.edges, counts.multi_edges, counts.loops };
+    };
+}
+
+Solve parse_shortcuts(const string& path, bool binary)
+{
+    int N, M, s, t;
+    shortcuts::num B;
+    vector<shortcuts::adjecency_list> adj;
+    if (binary)
+        adj = shortcuts::load_input(*open_corpus(path, CORPUS_SHORTCUTS), N, M, s, t, B);
+    else
+    {
+        IntReader in(path.c_str());
+        adj = shortcuts::get_input(in, N, M, s, t, B);
+    }
+    return [adj = move(adj), s, t, B]
+    {
+        return Answer{ shortcuts::shortest_path(s, t, B, adj) };
+    };
+}
+
+const Engine engines[] = {
+    { "cereal", "1/problem1/cereal", parse_cereal },
+    { "shops2", "1/problem2/shops2", parse_shops2 },
+    { "salaries", "2/salaries/salaries", parse_salaries },
+    { "relay", "2/relay/relay", parse_relay },
+    { "contagion", "3/contagion/contagion", parse_contagion },
+    { "shortcuts", "3/shortcuts/shortcuts", parse_shortcuts },
+};
+
+struct Options
+{
+    int warmup = 1;
+    int reps = 5;
+    bool binary = false;
+    long long first = 0, last = -1; // cases, all of them when last < first
+    long long memory_mb = 0; // no limit
+    string json;
+    string lab = ALGO_LAB_DIR;
+};
+
+struct Case
+{
+    const Engine* engine;
+    long long number; // the N of inputN
+    string input, output;
+};
+
+// every case of the engine's corpus, in order of N
+vector<Case> discover(const Engine& engine, const Options& options)
+{
+    vector<Case> cases;
+    fs::path dir = fs::path(options.lab) / engine.corpus;
+    error_code error;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir, error))
+    {
+        string name = entry.path().filename().string();
+        if (name.size() <= 9 || name.compare(0, 5, "input") != 0 || name.compare(name.size() - 4, 4, ".txt") != 0)
+            continue;
+        string digits = name.substr(5, name.size() - 9);
+        if (!all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            continue;
+        long long number = stoll(digits);
+        if (options.first <= options.last && (number < options.first || number > options.last))
+            continue;
+        fs::path input = dir / ("input" + digits + (options.binary ? ".bin" : ".txt"));
+        if (options.binary && !fs::exists(input))
+            continue;
+        cases.push_back({ &engine, number, input.string(), (dir / ("output" + digits + ".txt")).string() });
+    }
+    if (error)
+        fprintf(stderr, "%s: %s\n", dir.string().c_str(), error.message().c_str());
+    sort(cases.begin(), cases.end(), [](const Case& a, const Case& b) { return a.number < b.number; });
+    return cases;
+}
+
+// what a case's child reports back through the pipe
+enum Verdict : int { RIGHT, WRONG, NO_OUTPUT };
+
+bool write_all(int fd, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0)
+    {
+        ssize_t got = read(fd, bytes, size);
+        if (got <= 0)
+            return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+// the child's side: runs the case and writes the verdict and the timings to fd
+int run_case(const Case& test, const Options& options, int fd)
+{
+    if (options.memory_mb > 0)
+    {
+        rlimit limit;
+        limit.rlim_cur = limit.rlim_max = rlim_t(options.memory_mb) << 20;
+        setrlimit(RLIMIT_AS, &limit);
+    }
+    Verdict verdict = NO_OUTPUT;
+    Answer expected;
+    if (fs::exists(test.output))
+    {
+        IntReader out(test.output.c_str());
+        for (long long value = out.next<long long>(); out; value = out.next<long long>())
+            expected.push_back(value);
+        verdict = RIGHT;
+    }
+
+    vector<double> parse_ms, solve_ms;
+    try
+    {
+        for (int rep = 0; rep < options.warmup + options.reps; ++rep)
+        {
+            auto start = chrono::steady_clock::now();
+            Solve solve = test.engine->parse(test.input, options.binary);
+            double parsed = millis_since(start);
+            start = chrono::steady_clock::now();
+            Answer answer = solve();
+            double solved = millis_since(start);
+            if (verdict == RIGHT && answer != expected)
+                verdict = WRONG;
+            if (rep >= options.warmup)
+            {
+                parse_ms.push_back(parsed);
+                solve_ms.push_back(solved);
+            }
+        }
+    }
+    catch (const bad_alloc&)
+    {
+        return 3;
+    }
+    catch (const exception& error)
+    {
+        fprintf(stderr, "%s: %s\n", test.input.c_str(), error.what());
+        return 4;
+    }
+    bool sent = write_all(fd, &verdict, sizeof(verdict))
+             && write_all(fd, parse_ms.data(), parse_ms.size() * sizeof(double))
+             && write_all(fd, solve_ms.data(), solve_ms.size() * sizeof(double));
+    return sent ? 0 : 5;
+}
+
+struct Stats
+{
+    double min = 0, median = 0, p95 = 0;
+};
+
+Stats stats_of(vector<double> times)
+{
+    Stats stats;
+    if (times.empty())
+        return stats;
+    sort(times.begin(), times.end());
+    size_t n = times.size();
+    stats.min = times[0];
+    stats.median = (n % 2) ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    stats.p95 = times[size_t(ceil(0.95 * n)) - 1]; // nearest rank
+    return stats;
+}
+
+struct Result
+{
+    const Case* test;
+    string result; // right, wrong, no output, or what happened to the child
+    bool timed = false;
+    Stats parse, solve;
+    long peak_rss_kb = 0;
+};
+
+// the parent's side: forks, collects, waits
+Result measure(const Case& test, const Options& options)
+{
+    Result result;
+    result.test = &test;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        result.result = "no pipe";
+        return result;
+    }
+    fflush(stdout); // or the child flushes our buffer too
+    fflush(stderr);
+    pid_t child = fork();
+    if (child < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        result.result = "no fork";
+        return result;
+    }
+    if (child == 0)
+    {
+        close(fds[0]);
+        int status = run_case(test, options, fds[1]);
+        close(fds[1]);
+        exit(status); // exit, not _exit: an ALGO_PGO=GENERATE build writes its profile here
+    }
+
+    close(fds[1]);
+    Verdict verdict;
+    vector<double> parse_ms(options.reps), solve_ms(options.reps);
+    bool received = read_all(fds[0], &verdict, sizeof(verdict))
+                 && read_all(fds[0], parse_ms.data(), parse_ms.size() * sizeof(double))
+                 && read_all(fds[0], solve_ms.data(), solve_ms.size() * sizeof(double));
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    while (wait4(child, &status, 0, &usage) < 0 && errno == EINTR)
+        ;
+    result.peak_rss_kb = usage.ru_maxrss;
+
+    if (WIFSIGNALED(status))
+        result.result = string("killed by ") + strsignal(WTERMSIG(status));
+    else if (WEXITSTATUS(status) == 3)
+        result.result = "out of memory";
+    else if (WEXITSTATUS(status) != 0 || !received)
+        result.result = "failed";
+    else
+    {
+        result.result = verdict == RIGHT ? "right" : verdict == WRONG ? "wrong" : "no output";
+        result.timed = true;
+        result.parse = stats_of(parse_ms);
+        result.solve = stats_of(solve_ms);
+    }
+    return result;
+}
+
+void print_result(FILE* table, const Result& result)
+{
+    if (!result.timed)
+    {
+        fprintf(table, "%-10s %5lld  %-13s %*s %8.1f MB\n", result.test->engine->name, result.test->number,
+               result.result.c_str(), 64, "", result.peak_rss_kb / 1024.0);
+        return;
+    }
+    fprintf(table, "%-10s %5lld  %-13s %9.3f / %9.3f / %9.3f  %9.3f / %9.3f / %9.3f %8.1f MB\n",
+           result.test->engine->name, result.test->number, result.result.c_str(),
+           result.parse.min, result.parse.median, result.parse.p95,
+           result.solve.min, result.solve.median, result.solve.p95, result.peak_rss_kb / 1024.0);
+}
+
+// the few characters a path can have that JSON can't take as they are
+string json_string(const string& text)
+{
+    string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if ((unsigned char) c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else
+            quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void write_json(FILE* file, const vector<Result>& results, const Options& options)
+{
+    auto stats = [&](const char* name, const Stats& s)
+    {
+        fprintf(file, ", \"%s\": {\"min\": %.6f, \"median\": %.6f, \"p95\": %.6f}", name, s.min, s.median, s.p95);
+    };
+    fprintf(file, "{\n  \"warmup\": %d,\n  \"reps\": %d,\n  \"binary\": %s,\n  \"results\": [",
+            options.warmup, options.reps, options.binary ? "true" : "false");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        error_code error;
+        uintmax_t bytes = fs::file_size(result.test->input, error);
+        fprintf(file, "%s\n    {\"engine\": \"%s\", \"case\": %lld, \"input\": %s, \"bytes\": %ju, \"result\": %s, \"ok\": %s",
+                i ? "," : "", result.test->engine->name, result.test->number, json_string(result.test->input).c_str(),
+                error ? uintmax_t(0) : bytes, json_string(result.result).c_str(),
+                result.result == "right" ? "true" : "false");
+        if (result.timed)
+        {
+            stats("parse_ms", result.parse);
+            stats("solve_ms", result.solve);
+        }
+        fprintf(file, ", \"peak_rss_kb\": %ld}", result.peak_rss_kb);
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+int usage()
+{
+    fprintf(stderr, "usage: bench [--warmup W] [--reps R] [--bin] [--cases A-B] [--memory MB] [--json FILE] [--lab DIR]\n"
+                    "             [cereal|shops2|salaries|relay|contagion|shortcuts ...]\n");
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    vector<const Engine*> chosen;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--warmup" && has_value)
+            options.warmup = max(0, atoi(argv[++i]));
+        else if (arg == "--reps" && has_value)
+            options.reps = max(1, atoi(argv[++i]));
+        else if (arg == "--bin")
+            options.binary = true;
+        else if (arg == "--cases" && has_value)
+        {
+            string range = argv[++i];
+            size_t dash = range.find('-');
+            options.first = atoll(range.c_str());
+            options.last = dash == string::npos ? options.first : atoll(range.c_str() + dash + 1);
+        }
+        else if (arg == "--memory" && has_value)
+            options.memory_mb = atoll(argv[++i]);
+        else if (arg == "--json" && has_value)
+            options.json = argv[++i];
+        else if (arg == "--lab" && has_value)
+            options.lab = argv[++i];
+        else
+        {
+            const Engine* engine = find_if(begin(engines), end(engines), [&](const Engine& e) { return arg == e.name; });
+            if (engine == end(engines))
+                return usage();
+            chosen.push_back(engine);
+        }
+    }
+    if (chosen.empty())
+        for (const Engine& engine : engines)
+            chosen.push_back(&engine);
+
+    vector<Case> cases;
+    for (const Engine* engine : chosen)
+    {
+        vector<Case> found = discover(*engine, options);
+        if (found.empty())
+            fprintf(stderr, "%s: no cases in %s\n", engine->name, (fs::path(options.lab) / engine->corpus).string().c_str());
+        cases.insert(cases.end(), found.begin(), found.end());
+    }
+
+    FILE* table = options.json == "-" ? stderr : stdout;
+    fprintf(table, "%d warmup, %d timed runs per case, %s input\n", options.warmup, options.reps, options.binary ? "binary" : "text");
+    fprintf(table, "%-10s %5s  %-13s %-33s  %-33s %11s\n", "engine", "case", "result",
+           "parse ms (min / median / p95)", "solve ms (min / median / p95)", "peak RSS");
+    vector<Result> results;
+    int bad = 0;
+    for (const Case& test : cases)
+    {
+        results.push_back(measure(test, options));
+        print_result(table, results.back());
+        bad += results.back().result != "right" && results.back().result != "no output";
+    }
+    fprintf(table, "%zu cases, %d not right\n", results.size(), bad);
+
+    if (!options.json.empty())
+    {
+        FILE* file = options.json == "-" ? stdout : fopen(options.json.c_str(), "w");
+        if (!file)
+        {
+            fprintf(stderr, "can't write %s\n", options.json.c_str());
+            return 1;
+        }
+        write_json(file, results, options);
+        if (file != stdout)
+            fclose(file);
+    }
+    return bad ? 2 : 0;
+}
@@ -0,0 +1,246 @@
+/*
+ * Binary test cases, so that a benchmark doesn't spend its time parsing
+ * text. corpus_convert turns every inputN.txt / outputN.txt pair of a
+ * problem's directory into one inputN.bin:
+ *
+ *   CorpusHeader    magic, version, problem, how many sections, the
+ *                   instance's sizes (N, K, ...) and a checksum of
+ *                   everything after the header
+ *   sections        each a CorpusSection (element size and count) and then
+ *                   the elements, padded to 8 bytes so every array is
+ *                   aligned for its type
+ *
+ * Everything is little-endian and the last section is always the expected
+ * answer (empty when the case had no output file). What the other sections
+ * hold is up to the problem, corpus_convert.cpp lists them.
+ *
+ * CorpusFile maps such a file and hands out its sections as arrays that
+ * point straight into the mapping: loading is a checksum and nothing else.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "corpus files are little-endian and are mapped as they are"
+#endif
+
+enum CorpusProblem : uint32_t
+{
+    CORPUS_CEREAL = 1,
+    CORPUS_SHOPS2 = 2,
+    CORPUS_SALARIES = 3,
+    CORPUS_RELAY = 4,
+    CORPUS_CONTAGION = 5,
+    CORPUS_SHORTCUTS = 6
+};
+
+#define CORPUS_MAGIC "ALGOCORP"
+#define CORPUS_VERSION 1
+#define CORPUS_SIZES 6
+
+struct CorpusHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t problem;
+    uint32_t sections;
+    uint32_t reserved;
+    int64_t sizes[CORPUS_SIZES]; // unused ones are 0
+    uint64_t checksum;
+};
+
+struct CorpusSection
+{
+    uint64_t count;
+    uint32_t element_size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CorpusHeader) == 80 && sizeof(CorpusSection) == 16, "no padding in the file layout");
+
+// 8 bytes at a time, the tail zero-padded, which the sections always are anyway
+inline uint64_t corpus_checksum(const char* data, size_t size)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ size;
+    for (size_t i = 0; i < size; i += 8)
+    {
+        uint64_t word = 0;
+        memcpy(&word, data + i, (size - i < 8) ? size - i : 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// a section of a mapped file, valid while the CorpusFile is
+template <typename T>
+struct CorpusArray
+{
+    const T* data = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+    size_t size() const { return count; }
+    const T& operator[](size_t i) const { return data[i]; }
+    std::vector<T> vector() const { return std::vector<T>(begin(), end()); }
+};
+
+class CorpusWriter
+{
+public:
+    explicit CorpusWriter(CorpusProblem problem)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CORPUS_MAGIC, 8);
+        header.version = CORPUS_VERSION;
+        header.problem = problem;
+    }
+
+    void size(int i, int64_t value) { header.sizes[i] = value; }
+
+    template <typename T>
+    void add(const T* values, size_t count)
+    {
+        CorpusSection section = { count, sizeof(T), 0 };
+        append(&section, sizeof(section));
+        append(values, count * sizeof(T));
+        body.resize((body.size() + 7) & ~size_t(7), 0);
+        ++header.sections;
+    }
+
+    template <typename T>
+    void add(const std::vector<T>& values) { add(values.data(), values.size()); }
+
+    // returns false if the file couldn't be written
+    bool save(const char* path)
+    {
+        header.checksum = corpus_checksum(body.data(), body.size());
+        FILE* file = fopen(path, "wb");
+        if (!file)
+            return false;
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+               && fwrite(body.data(), 1, body.size(), file) == body.size();
+        return fclose(file) == 0 && ok;
+    }
+
+private:
+    CorpusHeader header;
+    std::vector<char> body;
+
+    void append(const void* data, size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        body.insert(body.end(), bytes, bytes + size);
+    }
+};
+
+class CorpusFile
+{
+public:
+    // with a problem other than 0 the case has to be of that problem
+    explicit CorpusFile(const char* path, uint32_t problem = 0)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            error = "can't open the file";
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(CorpusHeader))
+        {
+            mapped_size = info.st_size;
+            void* data = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+                mapped = static_cast<const char*>(data);
+        }
+        ::close(fd);
+        if (!mapped)
+            error = "not a corpus file";
+        else
+            error = check(problem);
+    }
+
+    CorpusFile(const CorpusFile&) = delete;
+    CorpusFile& operator=(const CorpusFile&) = delete;
+
+    ~CorpusFile()
+    {
+        if (mapped)
+            munmap(const_cast<char*>(mapped), mapped_size);
+    }
+
+    explicit operator bool() const { return error == nullptr; }
+    const char* what() const { return error; }
+
+    uint32_t problem() const { return header().problem; }
+    int64_t size(int i) const { return header().sizes[i]; }
+    size_t sections() const { return offsets.size(); }
+
+    // section i as an array of T, empty if there is no such section or its
+    // elements aren't T-sized
+    template <typename T>
+    CorpusArray<T> section(size_t i) const
+    {
+        CorpusArray<T> array;
+        if (i >= offsets.size())
+            return array;
+        const CorpusSection* at = reinterpret_cast<const CorpusSection*>(mapped + offsets[i]);
+        if (at->element_size == sizeof(T))
+        {
+            array.data = reinterpret_cast<const T*>(at + 1);
+            array.count = at->count;
+        }
+        return array;
+    }
+
+    template <typename T>
+    CorpusArray<T> answer() const { return section<T>(sections() - 1); }
+
+private:
+    const char* mapped = nullptr;
+    size_t mapped_size = 0;
+    const char* error = nullptr;
+    std::vector<size_t> offsets; // of every CorpusSection in the file
+
+    const CorpusHeader& header() const { return *reinterpret_cast<const CorpusHeader*>(mapped); }
+
+    const char* check(uint32_t problem)
+    {
+        if (memcmp(header().magic, CORPUS_MAGIC, 8) != 0)
+            return "not a corpus file";
+        if (header().version != CORPUS_VERSION)
+            return "unknown corpus version";
+        if (problem && header().problem != problem)
+            return "a case of another problem";
+        if (corpus_checksum(mapped + sizeof(CorpusHeader), mapped_size - sizeof(CorpusHeader)) != header().checksum)
+            return "checksum mismatch";
+        size_t at = sizeof(CorpusHeader);
+        for (uint32_t i = 0; i < header().sections; ++i)
+        {
+            if (mapped_size - at < sizeof(CorpusSection))
+                return "truncated";
+            const CorpusSection* section = reinterpret_cast<const CorpusSection*>(mapped + at);
+            size_t bytes = section->count * section->element_size;
+            if (section->element_size == 0 || bytes / section->element_size != section->count
+                || mapped_size - at - sizeof(CorpusSection) < bytes)
+                return "truncated";
+            offsets.push_back(at);
+            at += sizeof(CorpusSection) + ((bytes + 7) & ~size_t(7));
+            if (at > mapped_size)
+                return "truncated";
+        }
+        if (offsets.empty())
+            return "no answer section";
+        return nullptr;
+    }
+};
@@ -0,0 +1,149 @@
+/*
+ * corpus_convert PROBLEM DIR
+ *
+ * Writes DIR/inputN.bin (see corpus.hpp) next to every DIR/inputN.txt,
+ * N = 0, 1, 2 ... until one is missing (0 may be). PROBLEM is one of
+ * cereal, shops2, salaries, relay, contagion, shortcuts and decides the
+ * sections, the answer is always the last one:
+ *
+ *   cereal      sizes N K          int64 values[N]                  int64 answer
+ *   shops2      sizes N K          int32 residents[N]               int32 answer
+ *   salaries    sizes N K          int64 p[N]                       int32 answer
+ *   relay       sizes N            uint32 u[N-1], v[N-1]
+ *                                  uint64 w[N-1]
+ *                                  uint32 P[N], S[N] (P[0] = S[0] = 0)
+ *                                                                   uint64 D[1..N-1]
+ *   contagion   sizes N F          int32 seeds[63]                  int32 edges, multi, loops
+ *   shortcuts   sizes N M s t B    int32 u[M], v[M], w[M]           int32 answer
+ *
+ * Vertex names are kept as they are in the text (from 1).
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "int_reader.hpp"
+#include "corpus.hpp"
+
+using namespace std;
+
+template <typename T>
+vector<T> read_many(IntReader& in, size_t count)
+{
+    vector<T> values(count);
+    for (T& value : values)
+        in >> value;
+    return values;
+}
+
+// whatever is left, for the answers
+template <typename T>
+vector<T> read_rest(IntReader& in)
+{
+    vector<T> values;
+    for (T value = in.next<T>(); in; value = in.next<T>())
+        values.push_back(value);
+    return values;
+}
+
+// the sections of one case, false if the input ended too soon
+bool convert(const string& problem, IntReader& in, IntReader& out, CorpusWriter& corpus)
+{
+    if (problem == "cereal" || problem == "shops2" || problem == "salaries")
+    {
+        long long N, K;
+        in >> N >> K;
+        corpus.size(0, N);
+        corpus.size(1, K);
+        if (problem == "shops2")
+            corpus.add(read_many<int32_t>(in, N));
+        else
+            corpus.add(read_many<int64_t>(in, N));
+        if (problem == "cereal")
+            corpus.add(read_rest<int64_t>(out));
+        else
+            corpus.add(read_rest<int32_t>(out));
+    }
+    else if (problem == "relay")
+    {
+        uint32_t N = in.next<uint32_t>();
+        if (N == 0)
+            return false;
+        corpus.size(0, N);
+        vector<uint32_t> u(N - 1), v(N - 1), P(N, 0), S(N, 0);
+        vector<uint64_t> w(N - 1);
+        for (uint32_t i = 0; i + 1 < N; ++i)
+            in >> u[i] >> v[i] >> w[i];
+        for (uint32_t i = 1; i < N; ++i)
+            in >> P[i] >> S[i];
+        corpus.add(u);
+        corpus.add(v);
+        corpus.add(w);
+        corpus.add(P);
+        corpus.add(S);
+        corpus.add(read_rest<uint64_t>(out));
+    }
+    else if (problem == "contagion")
+    {
+        long long N, F;
+        in >> N >> F;
+        corpus.size(0, N);
+        corpus.size(1, F);
+        corpus.add(read_many<int32_t>(in, 63));
+        corpus.add(read_rest<int32_t>(out));
+    }
+    else // shortcuts
+    {
+        long long N, M, s, t, B;
+        in >> N >> M >> s >> t >> B;
+        long long sizes[5] = { N, M, s, t, B };
+        for (int i = 0; i < 5; ++i)
+            corpus.size(i, sizes[i]);
+        vector<int32_t> u(M), v(M), w(M);
+        for (long long i = 0; i < M; ++i)
+            in >> u[i] >> v[i] >> w[i];
+        corpus.add(u);
+        corpus.add(v);
+        corpus.add(w);
+        corpus.add(read_rest<int32_t>(out));
+    }
+    return bool(in);
+}
+
+int main(int argc, char* argv[])
+{
+    const string problems[6] = { "cereal", "shops2", "salaries", "relay", "contagion", "shortcuts" };
+    int id = 0;
+    while (argc == 3 && id < 6 && problems[id] != argv[1])
+        ++id;
+    if (argc != 3 || id == 6)
+    {
+        cerr << "usage: corpus_convert cereal|shops2|salaries|relay|contagion|shortcuts DIR" << endl;
+        return 1;
+    }
+
+    string dir = argv[2];
+    int converted = 0;
+    for (int i = 0; ; ++i)
+    {
+        string input = dir + "/input" + to_string(i) + ".txt";
+        if (!ifstream(input))
+        {
+            if (i == 0)
+                continue;
+            break;
+        }
+        IntReader in(input.c_str());
+        IntReader out((dir + "/output" + to_string(i) + ".txt").c_str());
+        CorpusWriter corpus(CorpusProblem(id + 1));
+        string binary = dir + "/input" + to_string(i) + ".bin";
+        if (!convert(problems[id], in, out, corpus))
+            cerr << input << " ends too soon, skipped" << endl;
+        else if (!corpus.save(binary.c_str()))
+            cerr << "can't write " << binary << endl;
+        else
+            ++converted;
+    }
+    cout << converted << " cases written to " << dir << endl;
+    return 0;
+}
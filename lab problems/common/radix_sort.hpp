@@ -0,0 +1,56 @@
+/*
+ * The LSD radix sort behind cereal's ranks and salaries' coordinate
+ * compression. radix_key turns an integer of any width into an unsigned key
+ * with the same order (negative values first), radix_sort sorts the keys 8
+ * bits per pass and moves an int payload (usually the indices 0..N-1) along
+ * with them, and radix_value turns a key back into its value.
+ * A pass where every key has the same byte is skipped, so small values take
+ * few passes whatever the type is. O(N) per pass, plus one buffer of each.
+ */
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+std::make_unsigned_t<T> radix_key(T value)
+{
+    using U = std::make_unsigned_t<T>;
+    const U flip = std::is_signed_v<T> ? U(1) << (8 * sizeof(T) - 1) : 0;
+    return U(value) ^ flip;
+}
+
+template <typename T>
+T radix_value(std::make_unsigned_t<T> key)
+{
+    return T(radix_key(T(key))); // flipping the top bit again undoes it
+}
+
+// sorts key and applies the same moves to index, stable
+template <typename U>
+void radix_sort(std::vector<U>& key, std::vector<int>& index)
+{
+    static_assert(std::is_unsigned_v<U>, "radix_key makes the keys");
+    int N = key.size();
+    std::vector<U> key_buffer(N);
+    std::vector<int> index_buffer(N);
+    for (int shift = 0; shift < 8 * int(sizeof(U)); shift += 8)
+    {
+        std::vector<int> count(257, 0);
+        for (int i = 0; i < N; ++i)
+            ++count[((key[i] >> shift) & 255) + 1];
+        if (*std::max_element(count.begin(), count.end()) == N)
+            continue; // every key has the same byte here
+        for (int d = 0; d < 256; ++d)
+            count[d + 1] += count[d];
+        for (int i = 0; i < N; ++i)
+        {
+            int to = count[(key[i] >> shift) & 255]++;
+            key_buffer[to] = key[i];
+            index_buffer[to] = index[i];
+        }
+        key.swap(key_buffer);
+        index.swap(index_buffer);
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * The wall-clock timing every driver and bench use: how long since a
+ * time_point of any clock, or how long one call of a function took, in
+ * seconds or in milliseconds.
+ */
+#pragma once
+
+#include <chrono>
+
+template <typename Clock, typename Duration>
+double seconds_since(std::chrono::time_point<Clock, Duration> start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename Clock, typename Duration>
+double millis_since(std::chrono::time_point<Clock, Duration> start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// runs f once
+template <typename F>
+double timed_seconds(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return seconds_since(start);
+}
+
+template <typename F>
+double timed_millis(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return millis_since(start);
+}